@@ -11,13 +11,15 @@ void algorithms_reset(Simulator *sim);
 void algorithms_free(Simulator *sim);
 
 // Registra que una página fue cargada en RAM para actualizar el algoritmo.
-void algorithms_on_page_loaded(Simulator *sim, Page *page);
+void algorithms_on_page_loaded(Simulator *sim, sim_pageid_t page_id);
 // Informa que una página fue expulsada para que el algoritmo actualice su estado.
-void algorithms_on_page_evicted(Simulator *sim, Page *page);
+void algorithms_on_page_evicted(Simulator *sim, sim_pageid_t page_id);
 // Notifica un acceso a página para actualizar contadores y pistas del algoritmo.
-void algorithms_on_page_accessed(Simulator *sim, Page *page);
+void algorithms_on_page_accessed(Simulator *sim, sim_pageid_t page_id);
 
 // Elige el identificador de la página víctima según la política activa.
 sim_pageid_t choose_victim(Simulator *sim);
+// Indica si la página tiene el bit de referencia encendido para la política activa.
+int algorithms_page_referenced(const Simulator *sim, sim_pageid_t page_id);
 
 #endif
@@ -6,12 +6,19 @@
 #include <stdint.h>
 #include <string.h>
 
-#define PAGE_SIZE 4096
-#define RAM_FRAMES 100
+// Valores por defecto; cada Simulator recibe su tamaño de página y cantidad de marcos en sim_init.
+#define DEFAULT_PAGE_SIZE 4096
+#define DEFAULT_RAM_FRAMES 100
 
 typedef uint32_t sim_pid_t;
 typedef uint32_t sim_ptr_t;
 typedef uint32_t sim_pageid_t;
 typedef uint64_t sim_time_t;
 
+// Estado de un generador PCG32; cada simulador tiene el suyo para que las corridas sean reproducibles.
+typedef struct SimRng {
+    uint64_t state;
+    uint64_t inc;
+} SimRng;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include "id_map.h"
+#include "instr_parser.h"
+#include "page_alloc.h"
+
+// Rango contiguo de ids de página.
+typedef struct PageSpan {
+    sim_pageid_t first_page;
+    uint32_t num_pages;
+} PageSpan;
+
+// Lista de punteros vivos de un proceso durante la traducción incremental.
+typedef struct StreamProcess {
+    sim_ptr_t *ptrs;
+    size_t count;
+    size_t capacity;
+} StreamProcess;
+
+// Traduce instrucciones a eventos de página una por una, con las mismas reglas que precompute_events.
+// Solo guarda los punteros vivos (en un IdMap) y sus procesos, así que sirve para trazas que no
+// caben en memoria. Los ids de página salen de un PageIdAllocator con la misma distancia de
+// reutilización que los simuladores que consumen los eventos.
+typedef struct EventBuilder {
+    size_t page_size;
+    PageIdAllocator page_ids;
+    IdMap ptrs;                  // ptr_id -> first_page | num_pages << 32
+    StreamProcess *processes;    // indexado por pid
+    size_t process_capacity;
+    PageSpan *released;          // rangos liberados por la última instrucción
+    size_t released_count;
+    size_t released_capacity;
+} EventBuilder;
+
+// Instrucción junto con su traducción a páginas, para etapas que traducen fuera del administrador.
+// released apunta a released_count rangos válidos hasta la siguiente traducción.
+typedef struct TranslatedInstr {
+    Instruction ins;
+    PageSpan access;
+    const PageSpan *released;
+    size_t released_count;
+} TranslatedInstr;
+
+// Prepara el traductor para páginas de page_size bytes (0 = DEFAULT_PAGE_SIZE); reuse_distance es la
+// del PageIdAllocator (PAGE_ALLOC_NO_REUSE para no reciclar ids).
+void event_builder_init(EventBuilder *builder, size_t page_size, size_t reuse_distance);
+// Procesa una instrucción: devuelve el rango de páginas accedidas (num_pages 0 si ninguna) y deja
+// en released/released_count los rangos que dejan de existir.
+PageSpan event_builder_next(EventBuilder *builder, const Instruction *ins);
+// Libera las tablas del traductor.
+void event_builder_free(EventBuilder *builder);
+
+#endif
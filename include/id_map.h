@@ -0,0 +1,27 @@
+#ifndef ID_MAP_H
+#define ID_MAP_H
+
+#include "common.h"
+
+// Tabla hash de direccionamiento abierto de ids de 32 bits a valores de 64 bits.
+// La clave 0 queda reservada como hueco: los ids de página y de puntero empiezan en 1.
+// Su memoria es proporcional a las claves presentes, no al mayor id visto.
+typedef struct IdMap {
+    uint32_t *keys;
+    uint64_t *values;
+    size_t capacity;         // potencia de dos
+    size_t count;
+} IdMap;
+
+// Prepara una tabla vacía.
+void id_map_init(IdMap *map);
+// Devuelve el puntero al valor de key o NULL si no está.
+uint64_t *id_map_find(const IdMap *map, uint32_t key);
+// Inserta o reemplaza el valor de key.
+void id_map_put(IdMap *map, uint32_t key, uint64_t value);
+// Quita key si está; devuelve 1 si la quitó.
+int id_map_remove(IdMap *map, uint32_t key);
+// Libera los arreglos de la tabla.
+void id_map_free(IdMap *map);
+
+#endif
@@ -17,8 +17,39 @@ typedef struct {
     sim_ptr_t ptr_id;
 } Instruction;
 
+// Tamaño máximo de new(): aun con páginas de un byte la cantidad de páginas entra en sim_pageid_t.
+#define INSTR_MAX_SIZE UINT32_MAX
+
+// Validación semántica de instrucciones que ya traen ptr_id y pid resueltos (trazas binarias y
+// comprimidas). Aplica las mismas reglas que el parser de texto y además exige que los ptr_id de new()
+// sean los consecutivos que este asignaría y que use/delete lleven el pid del dueño del puntero.
+typedef struct InstrValidator InstrValidator;
+
+InstrValidator *instr_validator_create(void);
+// Valida la siguiente instrucción de la secuencia: 0 si es válida o -1 tras informar el error en stderr
+// con el número de registro (desde 1) en el lugar del número de línea.
+int instr_validator_check(InstrValidator *validator, const Instruction *instr);
+void instr_validator_free(InstrValidator *validator);
+// Valida una secuencia completa; devuelve 0 o -1 (con mensaje en stderr).
+int instr_validate_all(const Instruction *list, size_t n);
+
+// Lector incremental: mapea el archivo en memoria (o, si no es regular, lo lee por bloques a medida
+// que avanza) y valida y entrega una instrucción por vez sin copiar la traza a un arreglo de
+// instrucciones. El camino "-" lee la entrada estándar.
+typedef struct InstrReader InstrReader;
+
+// Abre el archivo de instrucciones; devuelve NULL si no se puede abrir.
+InstrReader *instr_reader_open(const char *path);
+// Entrega la siguiente instrucción: 1 si la hay, 0 al final y -1 ante un error de sintaxis o semántica.
+int instr_reader_next(InstrReader *reader, Instruction *out);
+// Cierra el archivo y libera el estado de validación.
+void instr_reader_close(InstrReader *reader);
 // Lee un archivo de texto y devuelve la lista de instrucciones válidas encontrada.
+// Los archivos grandes se analizan en paralelo con un hilo por CPU (ver parse_instructions_parallel).
 Instruction *parse_instructions_from_file(const char *path, size_t *count);
+// Analiza tramos del archivo alineados a líneas en hasta threads hilos (0 = uno por CPU) y luego asigna
+// ids y valida punteros y procesos en una pasada secuencial; errores y resultado son los del lector.
+Instruction *parse_instructions_parallel(const char *path, size_t *count, size_t threads);
 // Genera una secuencia aleatoria de instrucciones para pruebas controladas.
 Instruction *generate_instructions(int P, int N, unsigned int seed, size_t *count);
 // Guarda una lista de instrucciones en disco usando el formato esperado por el simulador.
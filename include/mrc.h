@@ -0,0 +1,38 @@
+#ifndef MRC_H
+#define MRC_H
+
+#include "sim_manager.h"
+
+// Curva de fallas de página en función de la cantidad de marcos, obtenida sin simular cada tamaño.
+typedef struct MissRatioCurve {
+    size_t *faults;          // faults[k]: fallas con k * frame_step marcos, k en [1, points]
+    size_t points;           // desde aquí la curva ya no cambia (pico de páginas vivas)
+    double frame_step;       // marcos por punto: 1 en la curva exacta, 1/tasa en la muestreada
+    size_t access_count;     // eventos de página analizados
+} MissRatioCurve;
+
+// Muestreador espacial (estilo SHARDS) que arma la curva de LRU en streaming.
+typedef struct ShardsSampler ShardsSampler;
+
+// Calcula la curva de LRU en una sola pasada por los eventos precomputados usando distancias de pila.
+void mrc_build_lru(const SimManager *mgr, MissRatioCurve *curve);
+// Calcula la curva de OPT en una sola pasada con una pila de prioridades ordenada por próximo uso.
+void mrc_build_opt(const SimManager *mgr, MissRatioCurve *curve);
+// Devuelve las fallas con frames marcos; más allá del último punto la curva es constante.
+size_t mrc_faults(const MissRatioCurve *curve, size_t frames);
+// Libera el arreglo de la curva.
+void mrc_free(MissRatioCurve *curve);
+
+// Crea un muestreador que conserva la fracción rate (0, 1] de las páginas según un hash de su id.
+// La memoria crece con las páginas vivas muestreadas, no con el largo de la traza.
+ShardsSampler *shards_create(double rate);
+// Registra un acceso a la página (NEW o USE, en el orden de los eventos).
+void shards_access(ShardsSampler *sampler, sim_pageid_t page_id);
+// Registra que la página deja de existir por un delete() o kill().
+void shards_release(ShardsSampler *sampler, sim_pageid_t page_id);
+// Arma la curva estimada reescalando marcos por 1/rate y fallas por eventos totales / muestreados.
+void shards_finish(const ShardsSampler *sampler, MissRatioCurve *curve);
+// Libera el muestreador.
+void shards_destroy(ShardsSampler *sampler);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef PAGE_ALLOC_H
+#define PAGE_ALLOC_H
+
+#include "common.h"
+
+// Sin reutilización: los ids se asignan siempre por encima del último, como un contador.
+#define PAGE_ALLOC_NO_REUSE SIZE_MAX
+
+// Rango de ids liberado; ready_at es el total de páginas asignadas a partir del cual puede reutilizarse.
+typedef struct PageIdRange {
+    sim_pageid_t first_page;
+    uint32_t num_pages;
+    uint64_t ready_at;
+} PageIdRange;
+
+// Asignador determinista de rangos contiguos de ids de página (empiezan en 1). Un rango liberado
+// vuelve a estar disponible después de reuse_distance páginas nuevas y cada pedido toma el primer
+// tramo libre de ids que alcanza. El resultado depende solo del conjunto de ids libres y no del orden
+// en que se liberaron dentro de una misma instrucción, así que el traductor, el preprocesamiento y
+// cada simulador obtienen los mismos ids con la misma secuencia de new()/delete()/kill().
+typedef struct PageIdAllocator {
+    sim_pageid_t next;           // primer id por encima de todos los asignados
+    size_t reuse_distance;
+    uint64_t allocated;          // páginas asignadas desde el último reinicio
+    PageIdRange *pending;        // liberados que todavía no cumplen reuse_distance, en orden de ready_at
+    size_t pending_head;
+    size_t pending_count;
+    size_t pending_capacity;
+    uint64_t *used;              // bit i de la palabra w: id w * 64 + i ocupado
+    uint64_t *run_pre;           // árbol sobre las palabras (raíz en 1, hojas desde words): tramo libre
+    uint64_t *run_suf;           // al principio, al final y el más largo de cada nodo
+    uint64_t *run_best;
+    size_t words;                // potencia de dos; 0 hasta el primer pedido con reutilización
+} PageIdAllocator;
+
+// Prepara el asignador; reuse_distance = PAGE_ALLOC_NO_REUSE deja los ids sin reciclar.
+void page_alloc_init(PageIdAllocator *ids, size_t reuse_distance);
+// Devuelve el primer id de un rango contiguo de num_pages ids (num_pages > 0). Termina el programa
+// si el rango no entra en sim_pageid_t en lugar de dar la vuelta y repetir ids.
+sim_pageid_t page_alloc_take(PageIdAllocator *ids, uint32_t num_pages);
+// Devuelve el rango [first_page, first_page + num_pages) al asignador.
+void page_alloc_release(PageIdAllocator *ids, sim_pageid_t first_page, uint32_t num_pages);
+// Olvida todas las asignaciones conservando reuse_distance y la memoria reservada.
+void page_alloc_reset(PageIdAllocator *ids);
+// Libera los arreglos del asignador.
+void page_alloc_free(PageIdAllocator *ids);
+
+#endif
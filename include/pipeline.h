@@ -0,0 +1,26 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "sim_manager.h"
+
+// Anillos por defecto entre etapas, en elementos.
+#define PIPELINE_DEFAULT_RING 4096
+
+// Lectura -> traducción -> simulación en hilos separados. Un hilo lector saca instrucciones de la
+// fuente (parser de texto, traza binaria o comprimida) y otro las traduce a páginas con un
+// EventBuilder; las etapas se conectan con anillos acotados de un productor y un consumidor, así que
+// la memoria no depende del largo de la traza. La última etapa es el administrador en modo ventana
+// (sim_manager_init_translated con pipeline_next como fuente) y sus hilos de simulación.
+typedef struct Pipeline Pipeline;
+
+// Arranca las etapas de lectura y traducción sobre source; ring_capacity se redondea a potencia de dos
+// (0 = PIPELINE_DEFAULT_RING). page_size y window deben ser los del administrador, así el traductor
+// recicla los ids de página con la misma distancia que los simuladores.
+Pipeline *pipeline_start(InstrSourceFn source, void *ctx, size_t page_size, size_t window, size_t ring_capacity);
+// TranslatedSourceFn para el administrador: 1 con la siguiente instrucción traducida, 0 al terminar
+// y -1 si la fuente falló. Solo debe llamarla un hilo.
+int pipeline_next(void *pipeline, TranslatedInstr *out);
+// Detiene las etapas aunque no se haya consumido todo, espera a los hilos y libera los anillos.
+void pipeline_stop(Pipeline *pipeline);
+
+#endif
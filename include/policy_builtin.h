@@ -0,0 +1,566 @@
+#ifndef POLICY_BUILTIN_H
+#define POLICY_BUILTIN_H
+
+#include "sim_types.h"
+#include "util.h"
+
+#include <string.h>
+
+// Estado y hooks de las políticas integradas. Se definen inline en este encabezado para que
+// algorithms.c arme sus tablas y sim_engine.c genere bucles especializados que los inlinean.
+
+// Max-heap indexado de marcos ocupados ordenado por el próximo uso de su página (OPT).
+typedef struct {
+	int *frames;                 // índices de marco en orden de heap
+	int *slot;                   // posición de cada marco dentro de frames (-1 si no está)
+	size_t count;
+} OptHeap;
+
+// Lista doblemente enlazada intrusiva sobre índices de marco; head es el último cargado o usado.
+typedef struct {
+	int *prev;
+	int *next;
+	int head;
+	int tail;
+} FrameList;
+
+// Mapas de bits por marco para Segunda Oportunidad: ocupación y bit de referencia.
+typedef struct {
+	uint64_t *occupied;
+	uint64_t *referenced;
+	size_t words;
+} FrameBits;
+
+// Estado de Segunda Oportunidad: mapas de bits y aguja del reloj.
+typedef struct {
+	FrameBits bits;
+	int clock_hand;
+} ScState;
+
+// Marcos ocupados en un arreglo denso con borrado swap-and-pop; slot da la posición de cada marco.
+typedef struct {
+	int *frames;
+	int *slot;                   // -1 si el marco no está en el conjunto
+	size_t count;
+} ResidentSet;
+
+// Indica si el id corresponde a una página viva de la tabla del simulador.
+static inline int page_exists(const Simulator *sim, sim_pageid_t id) {
+	return id != 0 && id < sim->mmu.pages.capacity && sim->mmu.pages.live[id];
+}
+
+// Obtiene la próxima referencia futura de una página leyendo el índice compartido en su cursor.
+static inline uint32_t opt_next_use_index(const Simulator *sim, sim_pageid_t id) {
+	const FutureUseIndex *index = sim->future_index;
+	if (index && !index->positions) {
+		return sim->mmu.pages.future_cursor[id];
+	}
+	if (!index || id >= index->page_capacity) {
+		return FUTURE_USE_NONE;
+	}
+	uint32_t cursor = sim->mmu.pages.future_cursor[id];
+	if (cursor < index->offsets[id + 1]) {
+		return index->positions[cursor];
+	}
+	return FUTURE_USE_NONE;
+}
+
+// Avanza el cursor de usos futuros luego de que la página fue accedida.
+static inline void opt_advance_future_use(Simulator *sim, sim_pageid_t id) {
+	PageTable *pt = &sim->mmu.pages;
+	const FutureUseIndex *index = sim->future_index;
+	if (index && !index->positions) {
+		// Modo ventana: el acceso actual es el del cursor y el enlace da el siguiente
+		uint32_t cursor = pt->future_cursor[id];
+		pt->future_cursor[id] = cursor != FUTURE_USE_NONE ? index->next_use[cursor] : FUTURE_USE_NONE;
+		pt->next_use_pos[id] = pt->future_cursor[id];
+		return;
+	}
+	if (opt_next_use_index(sim, id) != FUTURE_USE_NONE) {
+		pt->future_cursor[id]++;
+	}
+	pt->next_use_pos[id] = opt_next_use_index(sim, id);
+}
+
+// Refresca el valor cacheado del próximo uso.
+static inline void opt_refresh_next_use(Simulator *sim, sim_pageid_t id) {
+	sim->mmu.pages.next_use_pos[id] = opt_next_use_index(sim, id);
+}
+
+// Instrucción que libera la página según el índice (FUTURE_USE_NONE si nunca o fuera de la ventana).
+static inline uint32_t opt_release_index(const FutureUseIndex *index, sim_pageid_t id) {
+	if (!index->positions) {
+		const uint64_t *release = id_map_find(&index->release_map, id);
+		return release ? (uint32_t)*release : FUTURE_USE_NONE;
+	}
+	if (!index->release_at || id >= index->page_capacity) {
+		return FUTURE_USE_NONE;
+	}
+	return index->release_at[id];
+}
+
+// Indica si el marco a debe estar por encima del marco b en el heap OPT.
+// Gana el uso más lejano; entre páginas sin usos futuros, la que se libera más tarde (o nunca),
+// porque conservar la que se libera antes devuelve su marco más pronto. Así el orden no depende
+// de la cantidad de marcos y coincide con la pila de mrc_build_opt. Luego, el marco de menor índice.
+static inline int opt_heap_above(const Simulator *sim, int a, int b) {
+	const Frame *frames = sim->mmu.frames;
+	sim_pageid_t page_a = frames[a].page_id;
+	sim_pageid_t page_b = frames[b].page_id;
+	uint32_t use_a = sim->mmu.pages.next_use_pos[page_a];
+	uint32_t use_b = sim->mmu.pages.next_use_pos[page_b];
+	if (use_a != use_b) {
+		return use_a > use_b;
+	}
+	const FutureUseIndex *index = sim->future_index;
+	if (use_a == FUTURE_USE_NONE && index) {
+		uint32_t release_a = opt_release_index(index, page_a);
+		uint32_t release_b = opt_release_index(index, page_b);
+		if (release_a != release_b) {
+			return release_a > release_b;
+		}
+	}
+	return a < b;
+}
+
+// Ubica el marco en la posición pos del heap actualizando su slot.
+static inline void opt_heap_place(OptHeap *heap, size_t pos, int frame) {
+	heap->frames[pos] = frame;
+	heap->slot[frame] = (int)pos;
+}
+
+// Sube el elemento en pos mientras supere a su padre.
+static inline void opt_heap_sift_up(const Simulator *sim, OptHeap *heap, size_t pos) {
+	int frame = heap->frames[pos];
+	while (pos > 0) {
+		size_t parent = (pos - 1) / 2;
+		if (!opt_heap_above(sim, frame, heap->frames[parent])) {
+			break;
+		}
+		opt_heap_place(heap, pos, heap->frames[parent]);
+		pos = parent;
+	}
+	opt_heap_place(heap, pos, frame);
+}
+
+// Baja el elemento en pos mientras alguno de sus hijos lo supere.
+static inline void opt_heap_sift_down(const Simulator *sim, OptHeap *heap, size_t pos) {
+	int frame = heap->frames[pos];
+	for (;;) {
+		size_t child = pos * 2 + 1;
+		if (child >= heap->count) {
+			break;
+		}
+		if (child + 1 < heap->count && opt_heap_above(sim, heap->frames[child + 1], heap->frames[child])) {
+			child++;
+		}
+		if (!opt_heap_above(sim, heap->frames[child], frame)) {
+			break;
+		}
+		opt_heap_place(heap, pos, heap->frames[child]);
+		pos = child;
+	}
+	opt_heap_place(heap, pos, frame);
+}
+
+// Inserta un marco recién ocupado en el heap OPT.
+static inline void opt_heap_insert(const Simulator *sim, OptHeap *heap, int frame) {
+	if (heap->slot[frame] >= 0) {
+		return;
+	}
+	opt_heap_place(heap, heap->count++, frame);
+	opt_heap_sift_up(sim, heap, heap->count - 1);
+}
+
+// Quita un marco del heap OPT reemplazándolo por el último elemento.
+static inline void opt_heap_remove(const Simulator *sim, OptHeap *heap, int frame) {
+	int pos = heap->slot[frame];
+	if (pos < 0) {
+		return;
+	}
+	heap->slot[frame] = -1;
+	int last = heap->frames[--heap->count];
+	if ((size_t)pos == heap->count) {
+		return;
+	}
+	opt_heap_place(heap, (size_t)pos, last);
+	opt_heap_sift_up(sim, heap, (size_t)pos);
+	opt_heap_sift_down(sim, heap, (size_t)heap->slot[last]);
+}
+
+// Vacía el heap OPT marcando todos los marcos como ausentes.
+static inline void opt_heap_clear(OptHeap *heap, size_t frame_count) {
+	heap->count = 0;
+	if (heap->slot) {
+		memset(heap->slot, 0xff, frame_count * sizeof(int));
+	}
+}
+
+// Vacía la lista de marcos; prev == -2 marca a un marco fuera de la lista.
+static inline void frame_list_clear(FrameList *list, size_t frame_count) {
+	list->head = -1;
+	list->tail = -1;
+	for (size_t i = 0; list->prev && i < frame_count; ++i) {
+		list->prev[i] = -2;
+		list->next[i] = -1;
+	}
+}
+
+static inline int frame_list_contains(const FrameList *list, int frame) {
+	return list->prev[frame] != -2;
+}
+
+// Desengancha el marco de la lista si estaba en ella.
+static inline void frame_list_unlink(FrameList *list, int frame) {
+	if (!frame_list_contains(list, frame)) {
+		return;
+	}
+	int prev = list->prev[frame];
+	int next = list->next[frame];
+	if (prev >= 0) {
+		list->next[prev] = next;
+	} else {
+		list->head = next;
+	}
+	if (next >= 0) {
+		list->prev[next] = prev;
+	} else {
+		list->tail = prev;
+	}
+	list->prev[frame] = -2;
+	list->next[frame] = -1;
+}
+
+// Coloca el marco al frente de la lista, moviéndolo si ya estaba enlazado.
+static inline void frame_list_push_front(FrameList *list, int frame) {
+	if (list->head == frame) {
+		return;
+	}
+	frame_list_unlink(list, frame);
+	list->prev[frame] = -1;
+	list->next[frame] = list->head;
+	if (list->head >= 0) {
+		list->prev[list->head] = frame;
+	} else {
+		list->tail = frame;
+	}
+	list->head = frame;
+}
+
+// Devuelve la página del marco indicado o 0 si el marco no es válido.
+static inline sim_pageid_t frame_page(const Simulator *sim, int frame) {
+	if (frame < 0) {
+		return 0;
+	}
+	sim_pageid_t id = sim->mmu.frames[frame].page_id;
+	return page_exists(sim, id) ? id : 0;
+}
+
+static inline void frame_bit_set(uint64_t *bits, int frame) {
+	bits[(size_t)frame / 64] |= (uint64_t)1 << ((size_t)frame % 64);
+}
+
+static inline void frame_bit_clear(uint64_t *bits, int frame) {
+	bits[(size_t)frame / 64] &= ~((uint64_t)1 << ((size_t)frame % 64));
+}
+
+// Vacía ambos mapas de bits.
+static inline void frame_bits_clear(FrameBits *bits) {
+	if (bits->occupied) {
+		memset(bits->occupied, 0, bits->words * sizeof(uint64_t));
+		memset(bits->referenced, 0, bits->words * sizeof(uint64_t));
+	}
+}
+
+// Avanza el reloj sobre los marcos [from, to) de a una palabra: devuelve el primer marco ocupado
+// sin referencia y limpia en bloque las referencias de los marcos que deja atrás (-1 si no hay).
+static inline long sc_sweep(FrameBits *bits, size_t from, size_t to) {
+	while (from < to) {
+		size_t word = from / 64;
+		size_t word_end = (word + 1) * 64;
+		uint64_t mask = ~(uint64_t)0 << (from % 64);
+		if (word_end > to) {
+			mask &= ~(uint64_t)0 >> (word_end - to);
+		}
+		uint64_t candidates = bits->occupied[word] & ~bits->referenced[word] & mask;
+		if (candidates) {
+			unsigned bit = (unsigned)__builtin_ctzll(candidates);
+			bits->referenced[word] &= ~(mask & (((uint64_t)1 << bit) - 1));
+			return (long)(word * 64 + bit);
+		}
+		bits->referenced[word] &= ~mask;
+		from = word_end;
+	}
+	return -1;
+}
+
+// Vacía el conjunto de marcos residentes.
+static inline void resident_clear(ResidentSet *set, size_t frame_count) {
+	set->count = 0;
+	if (set->slot) {
+		memset(set->slot, 0xff, frame_count * sizeof(int));
+	}
+}
+
+// Agrega un marco al final del arreglo denso.
+static inline void resident_add(ResidentSet *set, int frame) {
+	if (set->slot[frame] >= 0) {
+		return;
+	}
+	set->slot[frame] = (int)set->count;
+	set->frames[set->count++] = frame;
+}
+
+// Quita un marco moviendo el último elemento a su lugar.
+static inline void resident_remove(ResidentSet *set, int frame) {
+	int pos = set->slot[frame];
+	if (pos < 0) {
+		return;
+	}
+	int last = set->frames[--set->count];
+	set->frames[pos] = last;
+	set->slot[last] = pos;
+	set->slot[frame] = -1;
+}
+
+/* --- FIFO, LRU y MRU: lista de marcos en orden de carga o de uso --- */
+
+static inline void *frame_list_policy_init(Simulator *sim) {
+	FrameList *list = xmalloc(sizeof(*list));
+	list->prev = xmalloc(sim->mmu.frame_count * sizeof(int));
+	list->next = xmalloc(sim->mmu.frame_count * sizeof(int));
+	frame_list_clear(list, sim->mmu.frame_count);
+	return list;
+}
+
+static inline void frame_list_policy_reset(Simulator *sim, void *state) {
+	frame_list_clear(state, sim->mmu.frame_count);
+}
+
+static inline void frame_list_policy_free(Simulator *sim, void *state) {
+	(void)sim;
+	FrameList *list = state;
+	free(list->prev);
+	free(list->next);
+	free(list);
+}
+
+static inline void frame_list_policy_push(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	frame_list_push_front(state, frame);
+}
+
+static inline void frame_list_policy_unlink(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	frame_list_unlink(state, frame);
+}
+
+// Selecciona la siguiente página víctima usando la política FIFO: el marco cargado hace más tiempo.
+static inline sim_pageid_t fifo_choose(Simulator *sim, void *state) {
+	return frame_page(sim, ((FrameList *)state)->tail);
+}
+
+// Devuelve la página menos recientemente usada para el algoritmo LRU: el final de la lista.
+static inline sim_pageid_t lru_choose(Simulator *sim, void *state) {
+	return frame_page(sim, ((FrameList *)state)->tail);
+}
+
+// Devuelve la página más recientemente usada para el algoritmo MRU: el frente de la lista.
+static inline sim_pageid_t mru_choose(Simulator *sim, void *state) {
+	return frame_page(sim, ((FrameList *)state)->head);
+}
+
+/* --- Segunda Oportunidad --- */
+
+static inline void *sc_init(Simulator *sim) {
+	ScState *sc = xmalloc(sizeof(*sc));
+	sc->bits.words = (sim->mmu.frame_count + 63) / 64;
+	sc->bits.occupied = xmalloc(sc->bits.words * sizeof(uint64_t));
+	sc->bits.referenced = xmalloc(sc->bits.words * sizeof(uint64_t));
+	frame_bits_clear(&sc->bits);
+	sc->clock_hand = 0;
+	return sc;
+}
+
+static inline void sc_reset(Simulator *sim, void *state) {
+	(void)sim;
+	ScState *sc = state;
+	frame_bits_clear(&sc->bits);
+	sc->clock_hand = 0;
+}
+
+static inline void sc_free(Simulator *sim, void *state) {
+	(void)sim;
+	ScState *sc = state;
+	free(sc->bits.occupied);
+	free(sc->bits.referenced);
+	free(sc);
+}
+
+static inline void sc_on_loaded(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	ScState *sc = state;
+	frame_bit_set(sc->bits.occupied, frame);
+	frame_bit_set(sc->bits.referenced, frame);
+}
+
+static inline void sc_on_evicted(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	ScState *sc = state;
+	frame_bit_clear(sc->bits.occupied, frame);
+	frame_bit_clear(sc->bits.referenced, frame);
+}
+
+static inline void sc_on_accessed(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	frame_bit_set(((ScState *)state)->bits.referenced, frame);
+}
+
+// Implementa la política de segunda oportunidad recorriendo el reloj sobre los mapas de bits.
+static inline sim_pageid_t sc_choose(Simulator *sim, void *state) {
+	ScState *sc = state;
+	FrameBits *bits = &sc->bits;
+	size_t frames = sim->mmu.frame_count;
+	if (sc->clock_hand < 0 || (size_t)sc->clock_hand >= frames) {
+		sc->clock_hand = 0;
+	}
+
+	// Una vuelta completa desde la aguja: primero hasta el final y luego desde el marco 0
+	size_t hand = (size_t)sc->clock_hand;
+	long victim = sc_sweep(bits, hand, frames);
+	if (victim < 0) {
+		victim = sc_sweep(bits, 0, hand);
+	}
+
+	// Si todas tenían segunda oportunidad, se expulsa el primer marco ocupado
+	if (victim < 0) {
+		for (size_t w = 0; w < bits->words; ++w) {
+			if (bits->occupied[w]) {
+				victim = (long)(w * 64 + (size_t)__builtin_ctzll(bits->occupied[w]));
+				break;
+			}
+		}
+	}
+	if (victim < 0) {
+		return 0;
+	}
+	sc->clock_hand = (int)(((size_t)victim + 1) % frames);
+	return sim->mmu.frames[victim].page_id;
+}
+
+// El bit de referencia de Segunda Oportunidad vive en el mapa de bits del reloj.
+static inline int sc_referenced(const Simulator *sim, const void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	const ScState *sc = state;
+	return (int)((sc->bits.referenced[(size_t)frame / 64] >> ((size_t)frame % 64)) & 1);
+}
+
+/* --- Aleatorio --- */
+
+static inline void *rnd_init(Simulator *sim) {
+	ResidentSet *set = xmalloc(sizeof(*set));
+	set->frames = xmalloc(sim->mmu.frame_count * sizeof(int));
+	set->slot = xmalloc(sim->mmu.frame_count * sizeof(int));
+	resident_clear(set, sim->mmu.frame_count);
+	return set;
+}
+
+static inline void rnd_reset(Simulator *sim, void *state) {
+	resident_clear(state, sim->mmu.frame_count);
+}
+
+static inline void rnd_free(Simulator *sim, void *state) {
+	(void)sim;
+	ResidentSet *set = state;
+	free(set->frames);
+	free(set->slot);
+	free(set);
+}
+
+static inline void rnd_on_loaded(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	resident_add(state, frame);
+}
+
+static inline void rnd_on_evicted(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)page_id;
+	resident_remove(state, frame);
+}
+
+// Elige una página víctima al azar entre los marcos ocupados con un único acceso al arreglo denso.
+static inline sim_pageid_t rnd_choose(Simulator *sim, void *state) {
+	ResidentSet *set = state;
+	if (set->count == 0) {
+		return 0;
+	}
+	uint32_t r = rng_bounded(&sim->rng, (uint32_t)set->count);
+	return frame_page(sim, set->frames[r]);
+}
+
+/* --- OPT --- */
+
+static inline void *opt_init(Simulator *sim) {
+	OptHeap *heap = xmalloc(sizeof(*heap));
+	heap->frames = xmalloc(sim->mmu.frame_count * sizeof(int));
+	heap->slot = xmalloc(sim->mmu.frame_count * sizeof(int));
+	opt_heap_clear(heap, sim->mmu.frame_count);
+	return heap;
+}
+
+static inline void opt_reset(Simulator *sim, void *state) {
+	opt_heap_clear(state, sim->mmu.frame_count);
+}
+
+static inline void opt_free(Simulator *sim, void *state) {
+	(void)sim;
+	OptHeap *heap = state;
+	free(heap->frames);
+	free(heap->slot);
+	free(heap);
+}
+
+static inline void opt_on_loaded(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	opt_refresh_next_use(sim, page_id);
+	opt_heap_insert(sim, state, frame);
+}
+
+static inline void opt_on_evicted(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	opt_heap_remove(sim, state, frame);
+	opt_refresh_next_use(sim, page_id);
+}
+
+static inline void opt_on_accessed(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	OptHeap *heap = state;
+	opt_advance_future_use(sim, page_id);
+	// El próximo uso solo puede alejarse, así que el marco a lo sumo sube en el heap
+	if (heap->slot[frame] >= 0) {
+		opt_heap_sift_up(sim, heap, (size_t)heap->slot[frame]);
+	}
+}
+
+// Devuelve la página con uso más lejano según la política OPT: la raíz del heap.
+static inline sim_pageid_t opt_choose(Simulator *sim, void *state) {
+	OptHeap *heap = state;
+	if (heap->count == 0) {
+		return 0;
+	}
+	return frame_page(sim, heap->frames[0]);
+}
+
+// Hook vacío para las políticas que no reaccionan a un evento en los bucles especializados.
+static inline void policy_noop_hook(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+	(void)sim;
+	(void)state;
+	(void)page_id;
+	(void)frame;
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef REPLACEMENT_POLICY_H
+#define REPLACEMENT_POLICY_H
+
+#include "sim_types.h"
+
+// Versión de la tabla de operaciones; un módulo con otra versión se rechaza al cargarlo.
+#define REPLACEMENT_POLICY_API_VERSION 1
+// Símbolo que debe exportar cada módulo de política cargado con dlopen.
+#define REPLACEMENT_POLICY_ENTRY "pager_policy_entry"
+
+// Tabla de operaciones de una política de reemplazo. El simulador guarda un puntero a la tabla
+// y el estado privado que devuelve init; los hooks reciben la página y el marco que ocupa.
+// Todos los hooks salvo choose son opcionales (NULL).
+typedef struct ReplacementPolicy {
+    int api_version;
+    const char *name;
+    // Crea el estado privado de la política para el simulador.
+    void *(*init)(Simulator *sim);
+    // Vacía el estado al reiniciar la simulación conservando la memoria.
+    void (*reset)(Simulator *sim, void *state);
+    // Libera el estado creado por init.
+    void (*free)(Simulator *sim, void *state);
+    // La página acaba de ocupar el marco.
+    void (*on_loaded)(Simulator *sim, void *state, sim_pageid_t page_id, int frame);
+    // La página está por dejar el marco (expulsión, delete o kill).
+    void (*on_evicted)(Simulator *sim, void *state, sim_pageid_t page_id, int frame);
+    // Acceso a una página residente.
+    void (*on_accessed)(Simulator *sim, void *state, sim_pageid_t page_id, int frame);
+    // Devuelve la página a expulsar (0 deja que el motor elija el primer marco ocupado).
+    sim_pageid_t (*choose)(Simulator *sim, void *state);
+    // Bit de referencia propio de la política para la vista; NULL usa PageTable.ref_bit.
+    int (*referenced)(const Simulator *sim, const void *state, sim_pageid_t page_id, int frame);
+} ReplacementPolicy;
+
+// Firma de la función REPLACEMENT_POLICY_ENTRY que exporta un módulo.
+typedef const ReplacementPolicy *(*ReplacementPolicyEntryFn)(void);
+
+// Devuelve la política integrada del tipo indicado (NULL si no existe).
+const ReplacementPolicy *policy_builtin(AlgorithmType type);
+// Busca una política por nombre entre las integradas y las cargadas desde módulos.
+const ReplacementPolicy *policy_find(const char *name);
+// Carga un módulo compartido y registra su política; si falla devuelve NULL y describe el error en err.
+const ReplacementPolicy *policy_load_module(const char *path, char *err, size_t err_size);
+// Cierra todos los módulos cargados; ningún simulador debe seguir usando sus políticas.
+void policy_unload_modules(void);
+
+#endif
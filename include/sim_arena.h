@@ -0,0 +1,65 @@
+#ifndef SIM_ARENA_H
+#define SIM_ARENA_H
+
+#include "common.h"
+
+#define ARENA_CHUNK_SIZE (256 * 1024)
+#define ARENA_SIZE_CLASSES 40
+
+typedef struct ArenaChunk ArenaChunk;
+
+// Arena por simulador: reserva bloques grandes y entrega memoria avanzando un puntero.
+// Nada se libera individualmente; reset rebobina los bloques y release los devuelve al sistema.
+typedef struct SimArena {
+    ArenaChunk *head;        // primer bloque reservado
+    ArenaChunk *current;     // bloque del que se está asignando
+    size_t chunk_size;       // tamaño de bloque por defecto
+    size_t bytes_used;       // bytes entregados desde el último reset
+    size_t bytes_reserved;   // bytes pedidos al sistema
+    size_t high_water;       // máximo histórico de bytes_used
+} SimArena;
+
+// Slab tipado: objetos de tamaño fijo tomados de la arena y reciclados con una lista libre.
+typedef struct SimSlab {
+    SimArena *arena;
+    size_t object_size;
+    void *free_list;
+    size_t live;             // objetos en uso
+    size_t peak;             // máximo histórico de objetos en uso
+} SimSlab;
+
+// Arreglos de tamaño variable agrupados en clases de potencias de dos, una slab por clase.
+typedef struct SimArrayPool {
+    SimSlab classes[ARENA_SIZE_CLASSES];
+} SimArrayPool;
+
+// Prepara una arena vacía; el primer bloque se reserva en la primera asignación.
+void arena_init(SimArena *arena, size_t chunk_size);
+// Devuelve memoria alineada a 16 bytes avanzando el puntero del bloque actual.
+void *arena_alloc(SimArena *arena, size_t size);
+// Invalida todas las asignaciones conservando los bloques para reutilizarlos.
+void arena_reset(SimArena *arena);
+// Libera todos los bloques de la arena en una sola pasada.
+void arena_release(SimArena *arena);
+
+// Asocia una slab de objetos de object_size bytes a la arena.
+void slab_init(SimSlab *slab, SimArena *arena, size_t object_size);
+// Toma un objeto de la lista libre o, si está vacía, de la arena.
+void *slab_alloc(SimSlab *slab);
+// Devuelve el objeto a la lista libre de la slab.
+void slab_free(SimSlab *slab, void *obj);
+// Olvida la lista libre y los contadores; usar junto con arena_reset.
+void slab_reset(SimSlab *slab);
+
+// Inicializa una slab por clase de tamaño sobre la arena.
+void pool_init(SimArrayPool *pool, SimArena *arena);
+// Reserva un arreglo de al menos bytes bytes.
+void *pool_alloc(SimArrayPool *pool, size_t bytes);
+// Devuelve un arreglo reservado con pool_alloc indicando su tamaño original.
+void pool_free(SimArrayPool *pool, void *ptr, size_t bytes);
+// Cambia el tamaño de un arreglo copiando su contenido si cambia de clase.
+void *pool_realloc(SimArrayPool *pool, void *ptr, size_t old_bytes, size_t new_bytes);
+// Reinicia todas las clases; usar junto con arena_reset.
+void pool_reset(SimArrayPool *pool);
+
+#endif
@@ -5,13 +5,27 @@
 #include "instr_parser.h"
 
 // Inicializa estructuras básicas del simulador y selecciona el algoritmo de reemplazo.
-void sim_init(Simulator *sim, const char *name, AlgorithmType type);
+// Cantidad de marcos y tamaño de página se fijan por simulador (0 usa los valores por defecto).
+void sim_init(Simulator *sim, const char *name, AlgorithmType type, size_t frame_count, size_t page_size);
 // Restablece el simulador dejando memoria y estadísticas en cero.
 void sim_reset(Simulator *sim);
 // Libera todos los recursos asociados al simulador.
 void sim_free(Simulator *sim);
 // Ejecuta una instrucción y actualiza el estado y métricas de la simulación.
 void sim_process_instruction(Simulator *sim, const Instruction *ins, int global_index);
-void sim_set_future_dataset(Simulator *sim, const FutureUseDataset *dataset);
+// Asocia el índice compartido de usos futuros que consulta OPT; el simulador no lo copia.
+void sim_set_future_index(Simulator *sim, const FutureUseIndex *index);
+// Tras rearmar un índice en modo ventana, recoloca el cursor de las páginas indicadas (las que
+// aparecían en la ventana anterior o en la nueva) y reordena el estado de OPT.
+void sim_rebase_future_index(Simulator *sim, const sim_pageid_t *pages, size_t page_count);
+// Recicla los ids de página liberados después de reuse_distance páginas nuevas (PAGE_ALLOC_NO_REUSE,
+// el valor inicial, los deja sin reciclar); debe coincidir con la del traductor de los eventos.
+void sim_set_page_reuse(Simulator *sim, size_t reuse_distance);
+// Cambia la política de reemplazo (integrada o cargada de un módulo) y reinicia el simulador.
+void sim_set_policy(Simulator *sim, const struct ReplacementPolicy *policy);
+// Fija la semilla del generador de la política Random y lo reinicia.
+void sim_set_rng_seed(Simulator *sim, uint64_t seed);
+// Llena out con el consumo de memoria del simulador (arena, tabla de páginas, marcos).
+void sim_get_memory_stats(const Simulator *sim, SimMemoryStats *out);
 
 #endif
@@ -2,32 +2,90 @@
 #define SIM_MANAGER_H
 
 #include "sim_types.h"
+#include "event_stream.h"
 #include "instr_parser.h"
-typedef struct AccessEvent {
+
+// Rango de páginas que deja de existir por un delete() o kill(); sirve a los análisis que recorren
+// los eventos sin simular.
+typedef struct PageRelease {
     size_t instruction_index;
-    sim_pageid_t page_id;
-} AccessEvent;
+    sim_pageid_t first_page;
+    uint32_t num_pages;
+} PageRelease;
+
+// Instrucciones que avanzan todos los simuladores entre dos barreras de sim_manager_run.
+#define SIM_MANAGER_CHUNK 4096
+
+// Fuente de instrucciones del modo ventana: devuelve 1 si llenó *out, 0 al terminar y -1 ante un error.
+typedef int (*InstrSourceFn)(void *ctx, Instruction *out);
+// Fuente de instrucciones ya traducidas a páginas (ver pipeline.h), con los mismos valores de retorno.
+typedef int (*TranslatedSourceFn)(void *ctx, TranslatedInstr *out);
 
 typedef struct SimManager {
-    Simulator *sim_opt;
-    Simulator *sim_user;
+    Simulator *sim_opt;          // alias de sims[0]
+    Simulator *sim_user;         // alias de sims[1]
+    Simulator **sims;            // todos los simuladores sobre la misma carga
+    size_t sim_count;
+    size_t sim_capacity;
     Instruction *instructions;
     size_t instr_count;
     size_t current_index;
     size_t current_event_index;
     int running;
     AlgorithmType user_algorithm;
-    AccessEvent *events;
+    size_t frame_count;
+    size_t page_size;
+    sim_pageid_t *events;        // página de cada acceso, en orden de instrucción
     size_t event_count;
     size_t event_capacity;
-    size_t *instr_event_offsets;
-    FutureUseDataset future_dataset;
+    size_t *instr_event_offsets; // eventos de la instrucción i: [offsets[i], offsets[i + 1])
+    PageRelease *releases;       // en orden de instrucción
+    size_t release_count;
+    size_t release_capacity;
+    FutureUseIndex future_index;
+    // Modo ventana: instructions y events guardan solo el tramo [instr_base, ...) de la traza
+    size_t window;               // eventos de anticipación garantizados (0 = traza completa)
+    InstrSourceFn source;
+    TranslatedSourceFn translated_source;    // si no es NULL reemplaza a source y al builder
+    void *source_ctx;
+    int source_done;
+    int source_error;
+    EventBuilder builder;
+    size_t instr_capacity;
+    int owns_instructions;       // instructions lo reservó el administrador (modo ventana)
+    size_t instr_base;           // instrucciones ya descartadas de la ventana
+    size_t event_base;           // eventos ya descartados de la ventana
+    size_t window_stop;          // al llegar a esta instrucción se rearma la ventana
+    sim_pageid_t *window_pages;  // páginas de la ventana anterior y la nueva, para reubicar cursores
+    size_t window_page_capacity;
 } SimManager;
 
 // Configura el administrador con las instrucciones cargadas y el algoritmo del usuario.
 void sim_manager_init(SimManager *mgr, Instruction *instrs, size_t count, AlgorithmType user_alg);
+// Igual que sim_manager_init pero con cantidad de marcos y tamaño de página explícitos (0 = por defecto).
+void sim_manager_init_with_memory(SimManager *mgr, Instruction *instrs, size_t count, AlgorithmType user_alg,
+                                  size_t frame_count, size_t page_size);
+// Modo ventana para trazas que no caben en memoria: lee instrucciones de source a medida que avanza
+// y guarda solo las que cubren los próximos window eventos (entre window y 2 * window). OPT decide
+// con esa anticipación y las páginas que no aparecen en la ventana cuentan como sin usos futuros.
+void sim_manager_init_windowed(SimManager *mgr, InstrSourceFn source, void *ctx, AlgorithmType user_alg,
+                               size_t frame_count, size_t page_size, size_t window);
+// Igual que sim_manager_init_windowed pero las instrucciones llegan ya traducidas a páginas por otra
+// etapa (por ejemplo el hilo traductor de un Pipeline), así el administrador no usa su EventBuilder.
+void sim_manager_init_translated(SimManager *mgr, TranslatedSourceFn source, void *ctx, AlgorithmType user_alg,
+                                 size_t frame_count, size_t page_size, size_t window);
+// Distancia de reutilización de ids de página de los modos ventana: un id liberado vuelve a asignarse
+// después de 2 * window páginas nuevas, así dos vidas del mismo id nunca comparten una ventana y la
+// tabla de páginas crece con las páginas vivas y no con la longitud de la traza. Un traductor externo
+// (sim_manager_init_translated) debe usar la misma.
+size_t sim_manager_page_reuse_distance(size_t window);
+// Agrega otro simulador con la política indicada sobre la carga ya preprocesada.
+Simulator *sim_manager_add_simulator(SimManager *mgr, const char *name, AlgorithmType alg);
 // Avanza la simulación un paso respetando el ritmo elegido por la interfaz.
 void sim_manager_step(SimManager *mgr);
+// Corre todos los simuladores hasta el final de la carga repartidos en thread_count hilos
+// (0 = uno por simulador), sincronizados con una barrera cada SIM_MANAGER_CHUNK instrucciones.
+void sim_manager_run(SimManager *mgr, size_t thread_count);
 // Libera memoria y limpia punteros asociados al administrador de simulación.
 void sim_manager_free(SimManager *mgr);
 
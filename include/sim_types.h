@@ -2,53 +2,66 @@
 #define SIM_TYPES_H
 
 #include "common.h"
+#include "id_map.h"
+#include "page_alloc.h"
+#include "sim_arena.h"
 
-typedef struct FutureUseQueue {
-    size_t *positions;       // índices de eventos absolutos donde se usará esta página
-    size_t count;            // total de usos futuros registrados
-    size_t capacity;         // capacidad de almacenamiento para posiciones
-    size_t cursor;           // índice del próximo uso futuro (relativo al array de posiciones)
-} FutureUseQueue;
+#define FUTURE_USE_NONE UINT32_MAX
 
-typedef struct FutureUseEntry {
-    size_t *positions;       // lista inmutable de índices de acceso futuro para una página
-    size_t count;
-    size_t capacity;
-} FutureUseEntry;
+// Índice inmutable de usos futuros en formato CSR: los eventos que acceden a la página id
+// son positions[offsets[id] .. offsets[id + 1]) en orden creciente. Lo arma el administrador
+// una sola vez y los simuladores solo guardan un cursor por página sobre positions.
+// En modo ventana (positions == NULL) solo cubre los eventos de la ventana, con posiciones relativas
+// a su inicio: cada evento enlaza con el siguiente de su página y el cursor es el próximo uso mismo.
+typedef struct FutureUseIndex {
+    size_t *offsets;         // page_capacity + 1 entradas
+    uint32_t *positions;     // índices de evento absolutos
+    uint32_t *release_at;    // instrucción cuyo delete()/kill() libera la página (FUTURE_USE_NONE si nunca)
+    size_t page_capacity;    // ids de página cubiertos (0 .. page_capacity - 1)
+    size_t position_count;
+    uint32_t *next_use;      // modo ventana: siguiente evento de la misma página, por evento
+    IdMap first_use;         // modo ventana: página -> primer evento en la ventana
+    IdMap release_map;       // modo ventana: página -> instrucción de la ventana que la libera
+} FutureUseIndex;
 
-typedef struct FutureUseDataset {
-    FutureUseEntry *entries;
-    size_t capacity;
-} FutureUseDataset;
-
-typedef struct Page {
-    sim_pageid_t id;
-    sim_pid_t owner_pid;
-    sim_ptr_t owner_ptr;
-    uint32_t page_index;
-    int in_ram;
-    int frame_index;
-    int ref_bit;
-    int dirty;
-    sim_time_t last_used;
-    size_t next_use_pos;     // índice de evento absoluto en caché para OPT (SIZE_MAX si no hay)
-    FutureUseQueue future_uses;
-} Page;
+// Tabla de páginas en formato struct-of-arrays: cada campo es un arreglo indexado por id de página,
+// así los recorridos calientes (use, LRU, OPT) tocan memoria contigua sin perseguir punteros.
+typedef struct PageTable {
+    uint8_t *live;               // 1 si el id corresponde a una página existente
+    uint8_t *in_ram;
+    uint8_t *ref_bit;
+    int32_t *frame_index;        // marco que ocupa la página (-1 si no está en RAM)
+    sim_time_t *last_used;
+    uint32_t *next_use_pos;      // próximo evento que usa la página, en caché para OPT (FUTURE_USE_NONE si no hay)
+    sim_pid_t *owner_pid;
+    sim_ptr_t *owner_ptr;
+    uint32_t *page_index;        // posición de la página dentro de su puntero
+    uint32_t *future_cursor;     // posición en FutureUseIndex.positions del próximo uso
+    size_t count;                // páginas vivas
+    size_t capacity;             // entradas reservadas en cada arreglo
+} PageTable;
 
 typedef struct Frame {
     int occupied;
     sim_pageid_t page_id;
 } Frame;
 
+// Las páginas de un puntero son el rango [first_page, first_page + num_pages), que el
+// PageIdAllocator entrega siempre contiguo.
 typedef struct PtrMap {
     sim_ptr_t id;
     sim_pid_t owner_pid;
     uint32_t byte_size;
     uint32_t num_pages;
-    uint32_t pages_capacity;
-    sim_pageid_t *pages;
+    sim_pageid_t first_page;
 } PtrMap;
 
+// Devuelve el id de la i-ésima página del puntero.
+static inline sim_pageid_t ptrmap_page_at(const PtrMap *ptr, uint32_t i)
+{
+    return ptr->first_page + i;
+}
+
 typedef struct Process {
     sim_pid_t pid;
     PtrMap **ptrs;
@@ -63,15 +76,18 @@ typedef enum {
     ALG_SC,
     ALG_LRU,
     ALG_MRU,
-    ALG_RND
+    ALG_RND,
+    ALG_CUSTOM               // política externa fijada con sim_set_policy
 } AlgorithmType;
 
+struct ReplacementPolicy;
+
 typedef struct MMU {
-    Frame frames[RAM_FRAMES];
-    Page **pages;
-    size_t page_count;
-    size_t pages_capacity;
-    int free_frames[RAM_FRAMES];
+    Frame *frames;           // tabla de marcos físicos (frame_count entradas)
+    size_t frame_count;      // cantidad de marcos de RAM de este simulador
+    size_t page_size;        // tamaño de página en bytes
+    PageTable pages;
+    int *free_frames;        // pila de marcos libres (frame_count entradas)
     size_t free_count;
 } MMU;
 
@@ -86,26 +102,41 @@ typedef struct SimStats {
     size_t bytes_requested;
 } SimStats;
 
+// Costo de memoria propio del simulador (arena, tabla de páginas y marcos).
+typedef struct SimMemoryStats {
+    size_t arena_reserved;       // bytes pedidos al sistema por la arena
+    size_t arena_used;           // bytes entregados por la arena desde el último reset
+    size_t arena_high_water;     // máximo histórico de bytes entregados por la arena
+    size_t ptrmaps_peak;         // máximo de PtrMap vivos a la vez
+    size_t processes_peak;       // máximo de Process vivos a la vez
+    size_t page_table_bytes;     // arreglos de la PageTable
+    size_t frame_table_bytes;    // tabla de marcos y pila de libres
+} SimMemoryStats;
+
 typedef struct Simulator {
     char name[32];
     MMU mmu;
     Process **processes;
     size_t process_count;
     size_t process_capacity;
-    PtrMap **ptr_table;
-    size_t ptr_table_capacity;
-    size_t ptr_table_count;
+    IdMap ptr_table;             // ptr_id -> PtrMap *, solo los punteros vivos
     sim_time_t clock;
     sim_time_t thrashing_time;
     size_t total_pages_in_swap;
     AlgorithmType algorithm;
-    void *alg_state;
+    const struct ReplacementPolicy *policy;   // tabla de operaciones de la política activa
+    void *alg_state;                          // estado privado de la política
     SimStats stats;
-    sim_pageid_t next_page_id;
+    PageIdAllocator page_ids;
     sim_ptr_t next_ptr_id;
     size_t internal_fragmentation_bytes;
-    unsigned int rng_seed;
-    const FutureUseDataset *future_dataset;
+    uint64_t rng_seed;           // semilla con la que se reinicia rng en cada reset
+    SimRng rng;                  // generador de la política Random
+    const FutureUseIndex *future_index;   // compartido y de solo lectura
+    SimArena arena;              // dueña de PtrMap, Process y sus arreglos auxiliares
+    SimSlab ptrmap_slab;
+    SimSlab process_slab;
+    SimArrayPool arrays;         // listas de punteros por proceso, páginas por puntero, colas OPT
 } Simulator;
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include "instr_parser.h"
+
+// Formato binario versionado de trazas: cabecera de TRACE_HEADER_SIZE bytes seguida de registros de
+// TRACE_RECORD_SIZE bytes en little-endian (u32 tipo, u32 pid, u64 size, u32 ptr_id, u32 reservado).
+// En hosts little-endian el registro coincide con Instruction, así que el mapeo se usa sin copiar.
+#define TRACE_MAGIC "PGTRACE"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 72
+#define TRACE_RECORD_SIZE 24
+
+// Traza binaria abierta. instructions apunta al archivo mapeado (copia privada: escribir no lo
+// modifica) o, si el host no tiene la misma disposición, a un arreglo decodificado propio.
+typedef struct TraceFile {
+    Instruction *instructions;
+    size_t count;
+    size_t type_counts[4];   // instrucciones por InstrType
+    sim_pid_t max_pid;
+    sim_ptr_t max_ptr;
+    void *map;
+    size_t map_size;
+    int owned;               // instructions se reservó con malloc
+} TraceFile;
+
+// Devuelve 1 si el archivo empieza con la firma del formato binario.
+int trace_file_is_binary(const char *path);
+// Mapea la traza y verifica cabecera, tamaño, rangos, checksum y la semántica de las instrucciones
+// (instr_validate_all); devuelve 0 o -1 (con mensaje en stderr).
+int trace_file_open(TraceFile *trace, const char *path);
+// Desmapea la traza; acepta una estructura en cero.
+void trace_file_close(TraceFile *trace);
+// Guarda las instrucciones en formato binario si pasan instr_validate_all; devuelve 0 o -1 (con mensaje
+// en stderr).
+int trace_file_save(const char *path, const Instruction *list, size_t n);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TRACE_PACK_H
+#define TRACE_PACK_H
+
+#include "instr_parser.h"
+
+// Contenedor comprimido de trazas: cabecera, bloques independientes de hasta block_size instrucciones
+// codificadas con delta + varint, e índice de bloques al final. Cada bloque reinicia las predicciones,
+// así que se puede decodificar solo, en streaming o en paralelo con los demás.
+#define TRACE_PACK_MAGIC "PGTPACK"
+#define TRACE_PACK_VERSION 1
+#define TRACE_PACK_HEADER_SIZE 48
+#define TRACE_PACK_INDEX_ENTRY_SIZE 24
+#define TRACE_PACK_DEFAULT_BLOCK 65536
+
+// Entrada del índice: dónde está el bloque, cuánto ocupa y su checksum de bytes codificados.
+typedef struct TracePackBlock {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t count;
+    uint64_t checksum;
+} TracePackBlock;
+
+// Contenedor abierto: el archivo queda mapeado y el índice ya validado contra su tamaño.
+typedef struct TracePack {
+    const uint8_t *data;
+    size_t size;
+    size_t count;            // instrucciones totales
+    size_t block_size;       // instrucciones por bloque (el último puede tener menos)
+    TracePackBlock *blocks;
+    size_t block_count;
+} TracePack;
+
+// Lector en streaming: decodifica un bloque por vez, la memoria no depende del largo de la traza.
+typedef struct TracePackReader {
+    const TracePack *pack;
+    size_t block;            // próximo bloque a decodificar
+    Instruction *buffer;     // tantas instrucciones como el bloque más grande
+    size_t buffered;
+    size_t next;
+    InstrValidator *validator;  // semántica de lo entregado hasta ahora
+} TracePackReader;
+
+// Devuelve 1 si el archivo empieza con la firma del contenedor comprimido.
+int trace_pack_is_packed(const char *path);
+// Mapea el contenedor y valida cabecera e índice; devuelve 0 o -1 (con mensaje en stderr).
+int trace_pack_open(TracePack *pack, const char *path);
+// Desmapea el contenedor; acepta una estructura en cero.
+void trace_pack_close(TracePack *pack);
+// Decodifica el bloque b en out (capacidad block_size); devuelve 0 o -1 si el bloque está dañado.
+int trace_pack_decode_block(const TracePack *pack, size_t b, Instruction *out);
+// Decodifica la traza completa repartiendo los bloques entre threads hilos (0 = uno por CPU).
+// Devuelve NULL si algún bloque está dañado o la secuencia no pasa instr_validate_all.
+Instruction *trace_pack_decode_all(const TracePack *pack, size_t threads);
+// Prepara el lector en streaming sobre un contenedor abierto.
+void trace_pack_reader_init(TracePackReader *reader, const TracePack *pack);
+// Entrega la siguiente instrucción: 1 si la hay, 0 al final y -1 ante un bloque dañado o una
+// instrucción que no pasa la validación semántica.
+int trace_pack_reader_next(TracePackReader *reader, Instruction *out);
+// Libera el búfer y el validador del lector.
+void trace_pack_reader_free(TracePackReader *reader);
+// Guarda las instrucciones comprimidas en bloques de block_size (0 = TRACE_PACK_DEFAULT_BLOCK) si pasan
+// instr_validate_all; devuelve 0 o -1 (con mensaje en stderr).
+int trace_pack_save(const char *path, const Instruction *list, size_t n, size_t block_size);
+
+#endif
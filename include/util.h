@@ -9,5 +9,36 @@ void *xmalloc(size_t size);
 void log_debug(const char *fmt, ...);
 // Genera un entero aleatorio dentro del rango [min, max].
 int random_int(int min, int max);
+// Inicializa el generador PCG32 a partir de una semilla de 64 bits.
+void rng_seed(SimRng *rng, uint64_t seed);
+// Devuelve el siguiente valor de 32 bits del generador.
+uint32_t rng_next(SimRng *rng);
+// Devuelve un valor uniforme en [0, bound) sin sesgo de módulo (bound > 0).
+uint32_t rng_bounded(SimRng *rng, uint32_t bound);
+// Mezcla los bits de un entero de 64 bits (finalizador de SplitMix64) para usarlo como hash.
+uint64_t mix_u64(uint64_t x);
+// Informa "<kind> trace error in <path>: <reason>" en stderr y devuelve -1.
+int trace_error(const char *kind, const char *path, const char *reason);
+
+// Enteros little-endian de los formatos de traza en disco, independientes del orden del host.
+static inline void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline void put_le64(uint8_t *p, uint64_t v) {
+    put_le32(p, (uint32_t)v);
+    put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t get_le64(const uint8_t *p) {
+    return (uint64_t)get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
 
 #endif
@@ -0,0 +1,83 @@
+// Política de ejemplo cargable con `pager_bench -P plugins/lfu_policy.so`.
+// LFU: expulsa la página residente con menos accesos desde que entró a RAM.
+#include "replacement_policy.h"
+
+#include <stdlib.h>
+
+typedef struct LfuState {
+    uint64_t *hits;          // accesos de la página que ocupa cada marco
+    size_t frame_count;
+} LfuState;
+
+static void *lfu_init(Simulator *sim) {
+    LfuState *state = malloc(sizeof(*state));
+    if (!state) {
+        return NULL;
+    }
+    state->frame_count = sim->mmu.frame_count;
+    state->hits = calloc(state->frame_count, sizeof(uint64_t));
+    if (!state->hits) {
+        free(state);
+        return NULL;
+    }
+    return state;
+}
+
+static void lfu_reset(Simulator *sim, void *state) {
+    (void)sim;
+    LfuState *lfu = state;
+    for (size_t i = 0; i < lfu->frame_count; ++i) {
+        lfu->hits[i] = 0;
+    }
+}
+
+static void lfu_free(Simulator *sim, void *state) {
+    (void)sim;
+    LfuState *lfu = state;
+    if (lfu) {
+        free(lfu->hits);
+        free(lfu);
+    }
+}
+
+static void lfu_on_loaded(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+    (void)sim;
+    (void)page_id;
+    ((LfuState *)state)->hits[frame] = 0;
+}
+
+static void lfu_on_accessed(Simulator *sim, void *state, sim_pageid_t page_id, int frame) {
+    (void)sim;
+    (void)page_id;
+    ((LfuState *)state)->hits[frame]++;
+}
+
+// Recorre los marcos ocupados y devuelve la página con menos accesos.
+static sim_pageid_t lfu_choose(Simulator *sim, void *state) {
+    LfuState *lfu = state;
+    sim_pageid_t victim = 0;
+    uint64_t best = UINT64_MAX;
+    for (size_t i = 0; i < lfu->frame_count; ++i) {
+        const Frame *frame = &sim->mmu.frames[i];
+        if (frame->occupied && lfu->hits[i] < best) {
+            best = lfu->hits[i];
+            victim = frame->page_id;
+        }
+    }
+    return victim;
+}
+
+static const ReplacementPolicy lfu_policy = {
+    .api_version = REPLACEMENT_POLICY_API_VERSION,
+    .name = "lfu",
+    .init = lfu_init,
+    .reset = lfu_reset,
+    .free = lfu_free,
+    .on_loaded = lfu_on_loaded,
+    .on_accessed = lfu_on_accessed,
+    .choose = lfu_choose,
+};
+
+const ReplacementPolicy *pager_policy_entry(void) {
+    return &lfu_policy;
+}
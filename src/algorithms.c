@@ -1,294 +1,38 @@
 #include "algorithms.h"
-#include "util.h"
+#include "policy_builtin.h"
+#include "replacement_policy.h"
 
 #include <limits.h>
-#include <string.h>
 
-typedef struct {
-	sim_pageid_t *data;
-	size_t capacity;
-	size_t head;
-	size_t tail;
-	size_t count;
-} PageQueue;
-
-typedef struct {
-	PageQueue fifo_queue;
-	int clock_hand;
-} AlgorithmState;
-
-// Devuelve un puntero al estado interno del algoritmo para el simulador.
-static AlgorithmState *get_state(Simulator *sim) {
-	return (AlgorithmState *)sim->alg_state;
-}
-
-// Reserva memoria para estructuras del algoritmo y detiene el programa si falla.
-static void *alg_realloc(void *ptr, size_t size) {
-	void *tmp = realloc(ptr, size);
-	if (!tmp && size != 0) {
-		fprintf(stderr, "Out of memory (alg_realloc)\n");
-		exit(EXIT_FAILURE);
-	}
-	return tmp;
-}
-
-// Busca una página por id en la tabla global del simulador.
-static Page *get_page(const Simulator *sim, sim_pageid_t id) {
-	if (id == 0 || id >= sim->mmu.pages_capacity) {
+/* --- Tablas de las políticas integradas, indexadas por AlgorithmType --- */
+
+static const ReplacementPolicy builtin_policies[] = {
+	[ALG_OPT] = {REPLACEMENT_POLICY_API_VERSION, "opt", opt_init, opt_reset, opt_free,
+	             opt_on_loaded, opt_on_evicted, opt_on_accessed, opt_choose, NULL},
+	[ALG_FIFO] = {REPLACEMENT_POLICY_API_VERSION, "fifo", frame_list_policy_init, frame_list_policy_reset,
+	              frame_list_policy_free, frame_list_policy_push, frame_list_policy_unlink, NULL,
+	              fifo_choose, NULL},
+	[ALG_SC] = {REPLACEMENT_POLICY_API_VERSION, "sc", sc_init, sc_reset, sc_free,
+	            sc_on_loaded, sc_on_evicted, sc_on_accessed, sc_choose, sc_referenced},
+	[ALG_LRU] = {REPLACEMENT_POLICY_API_VERSION, "lru", frame_list_policy_init, frame_list_policy_reset,
+	             frame_list_policy_free, frame_list_policy_push, frame_list_policy_unlink,
+	             frame_list_policy_push, lru_choose, NULL},
+	[ALG_MRU] = {REPLACEMENT_POLICY_API_VERSION, "mru", frame_list_policy_init, frame_list_policy_reset,
+	             frame_list_policy_free, frame_list_policy_push, frame_list_policy_unlink,
+	             frame_list_policy_push, mru_choose, NULL},
+	[ALG_RND] = {REPLACEMENT_POLICY_API_VERSION, "rnd", rnd_init, rnd_reset, rnd_free,
+	             rnd_on_loaded, rnd_on_evicted, NULL, rnd_choose, NULL},
+};
+
+// Devuelve la tabla de la política integrada del tipo indicado.
+const ReplacementPolicy *policy_builtin(AlgorithmType type) {
+	if ((int)type < 0 || (size_t)type >= sizeof(builtin_policies) / sizeof(builtin_policies[0])) {
 		return NULL;
 	}
-	return sim->mmu.pages[id];
-}
-
-// Asegura que la cola pueda almacenar al menos la capacidad solicitada.
-static void queue_reserve(PageQueue *queue, size_t min_capacity) {
-	if (queue->capacity >= min_capacity) {
-		return;
-	}
-	size_t old_capacity = queue->capacity;
-	size_t new_capacity = old_capacity ? old_capacity * 2 : 32;
-	while (new_capacity < min_capacity) {
-		new_capacity *= 2;
-	}
-
-	sim_pageid_t *new_data = alg_realloc(NULL, new_capacity * sizeof(sim_pageid_t));
-	if (queue->count > 0 && queue->data && old_capacity > 0) {
-		for (size_t i = 0; i < queue->count; ++i) {
-			size_t idx = (queue->head + i) % old_capacity;
-			new_data[i] = queue->data[idx];
-		}
-	}
-	free(queue->data);
-	queue->data = new_data;
-	queue->capacity = new_capacity;
-	if (queue->count > 0) {
-		queue->head = 0;
-		queue->tail = queue->count - 1;
-	} else {
-		queue->head = queue->tail = 0;
-	}
-}
-
-// Inserta un nuevo identificador de página al final de la cola FIFO.
-static void queue_push(PageQueue *queue, sim_pageid_t value) {
-	queue_reserve(queue, queue->count + 1);
-	if (queue->capacity == 0) {
-		return;
-	}
-	if (queue->count == 0) {
-		queue->head = queue->tail = 0;
-		queue->data[queue->tail] = value;
-		queue->count = 1;
-		return;
-	}
-
-	queue->tail = (queue->tail + 1) % queue->capacity;
-	queue->data[queue->tail] = value;
-	queue->count++;
-}
-
-// Extrae el elemento del frente de la cola si existe.
-static void queue_pop_front(PageQueue *queue) {
-	if (queue->count == 0) {
-		return;
-	}
-	if (queue->count == 1) {
-		queue->head = queue->tail = 0;
-		queue->count = 0;
-		return;
-	}
-	queue->head = (queue->head + 1) % queue->capacity;
-	queue->count--;
-}
-
-// Consulta el valor en el frente sin retirarlo.
-static sim_pageid_t queue_peek_front(const PageQueue *queue) {
-	if (queue->count == 0) {
-		return 0;
-	}
-	return queue->data[queue->head];
-}
-
-// Limpia la cola para dejarla vacía.
-static void queue_clear(PageQueue *queue) {
-	queue->count = 0;
-	queue->head = queue->tail = 0;
-}
-
-// Genera un número pseudoaleatorio y actualiza la semilla del simulador.
-static unsigned int sim_rand(Simulator *sim) {
-	if (sim->rng_seed == 0) {
-		sim->rng_seed = 1;
-	}
-	sim->rng_seed = sim->rng_seed * 1103515245u + 12345u;
-	return (sim->rng_seed / 65536u) % 32768u;
-}
-
-// Obtiene la próxima referencia futura registrada para una página.
-static size_t opt_next_use_index(const Page *page) {
-	if (page->future_uses.cursor < page->future_uses.count) {
-		return page->future_uses.positions[page->future_uses.cursor];
-	}
-	return SIZE_MAX;
-}
-
-// Avanza el cursor de usos futuros luego de que la página fue accedida.
-static void opt_advance_future_use(Page *page) {
-	if (page->future_uses.cursor < page->future_uses.count) {
-		page->future_uses.cursor++;
-	}
-	page->next_use_pos = opt_next_use_index(page);
-}
-
-// Refresca el valor cacheado del próximo uso al actualizar la cola OPT.
-static void opt_refresh_next_use(Page *page) {
-	page->next_use_pos = opt_next_use_index(page);
-}
-
-// Selecciona la siguiente página víctima usando la política FIFO.
-static sim_pageid_t fifo_choose(Simulator *sim, AlgorithmState *state) {
-	if (!state) {
-		return 0;
-	}
-	while (state->fifo_queue.count > 0) {
-		sim_pageid_t candidate = queue_peek_front(&state->fifo_queue);
-		Page *page = get_page(sim, candidate);
-		if (page && page->in_ram) {
-			queue_pop_front(&state->fifo_queue);
-			return candidate;
-		}
-		queue_pop_front(&state->fifo_queue);
-	}
-	return 0;
+	return &builtin_policies[type];
 }
 
-// Implementa la política de segunda oportunidad recorriendo el reloj.
-static sim_pageid_t sc_choose(Simulator *sim, AlgorithmState *state) {
-	if (!state) {
-		return 0;
-	}
-	int scanned = 0;
-	int frames = RAM_FRAMES;
-	if (state->clock_hand < 0 || state->clock_hand >= frames) {
-		state->clock_hand = 0;
-	}
-
-	while (scanned < frames) {
-		Frame *frame = &sim->mmu.frames[state->clock_hand];
-		if (frame->occupied) {
-			Page *page = get_page(sim, frame->page_id);
-			if (page) {
-				if (page->ref_bit == 0) {
-					sim_pageid_t victim = frame->page_id;
-					state->clock_hand = (state->clock_hand + 1) % frames;
-					return victim;
-				}
-				page->ref_bit = 0;
-			}
-		}
-		state->clock_hand = (state->clock_hand + 1) % frames;
-		scanned++;
-	}
-
-	for (int i = 0; i < frames; ++i) {
-		Frame *frame = &sim->mmu.frames[i];
-		if (frame->occupied) {
-			state->clock_hand = (i + 1) % frames;
-			return frame->page_id;
-		}
-	}
-
-	return 0;
-}
-
-// Devuelve la página más recientemente usada para el algoritmo MRU.
-static sim_pageid_t mru_choose(Simulator *sim) {
-	sim_pageid_t candidate = 0;
-	sim_time_t best_time = 0;
-	for (int i = 0; i < RAM_FRAMES; ++i) {
-		Frame *frame = &sim->mmu.frames[i];
-		if (!frame->occupied) {
-			continue;
-		}
-		Page *page = get_page(sim, frame->page_id);
-		if (!page) {
-			continue;
-		}
-		if (candidate == 0 || page->last_used >= best_time) {
-			candidate = page->id;
-			best_time = page->last_used;
-		}
-	}
-	return candidate;
-}
-
-// Devuelve la página menos recientemente usada para el algoritmo LRU.
-static sim_pageid_t lru_choose(Simulator *sim) {
-	sim_pageid_t candidate = 0;
-	sim_time_t best_time = UINT64_MAX;
-	for (int i = 0; i < RAM_FRAMES; ++i) {
-		Frame *frame = &sim->mmu.frames[i];
-		if (!frame->occupied) {
-			continue;
-		}
-		Page *page = get_page(sim, frame->page_id);
-		if (!page) {
-			continue;
-		}
-		if (candidate == 0 || page->last_used < best_time) {
-			candidate = page->id;
-			best_time = page->last_used;
-		}
-	}
-	return candidate;
-}
-
-// Elige una página víctima al azar entre los marcos ocupados.
-static sim_pageid_t rnd_choose(Simulator *sim) {
-	sim_pageid_t buffer[RAM_FRAMES];
-	size_t count = 0;
-	for (int i = 0; i < RAM_FRAMES; ++i) {
-		Frame *frame = &sim->mmu.frames[i];
-		if (frame->occupied) {
-			buffer[count++] = frame->page_id;
-		}
-	}
-	if (count == 0) {
-		return 0;
-	}
-	unsigned int r = sim_rand(sim) % count;
-	return buffer[r];
-}
-
-// Busca la página con uso más lejano según la política OPT.
-static sim_pageid_t opt_choose(Simulator *sim) {
-	sim_pageid_t best_page = 0;
-	size_t farthest_use = 0;
-
-	for (int i = 0; i < RAM_FRAMES; ++i) {
-		Frame *frame = &sim->mmu.frames[i];
-		if (!frame->occupied) {
-			continue;
-		}
-		Page *page = get_page(sim, frame->page_id);
-		if (!page) {
-			continue;
-		}
-
-		size_t next_use = opt_next_use_index(page);
-		if (next_use == SIZE_MAX) {
-			return page->id;
-		}
-		if (best_page == 0 || next_use > farthest_use) {
-			farthest_use = next_use;
-			best_page = page->id;
-		}
-	}
-
-	return best_page;
-}
-
-// Reserva y prepara el estado común de todos los algoritmos de reemplazo.
+// Crea el estado privado de la política del simulador; sin política explícita usa la integrada.
 void algorithms_init(Simulator *sim) {
 	if (!sim) {
 		return;
@@ -297,101 +41,86 @@ void algorithms_init(Simulator *sim) {
 		algorithms_reset(sim);
 		return;
 	}
-	AlgorithmState *state = xmalloc(sizeof(*state));
-	memset(state, 0, sizeof(*state));
-	state->clock_hand = 0;
-	sim->alg_state = state;
+	if (!sim->policy) {
+		sim->policy = policy_builtin(sim->algorithm);
+	}
+	if (sim->policy && sim->policy->init) {
+		sim->alg_state = sim->policy->init(sim);
+	}
 }
 
 // Reinicia estructuras internas sin liberar memoria persistente.
 void algorithms_reset(Simulator *sim) {
-	if (!sim || !sim->alg_state) {
+	if (!sim || !sim->policy || !sim->policy->reset) {
 		return;
 	}
-	AlgorithmState *state = get_state(sim);
-	queue_clear(&state->fifo_queue);
-	state->clock_hand = 0;
+	sim->policy->reset(sim, sim->alg_state);
 }
 
-// Libera completamente la memoria usada por el estado del algoritmo.
+// Libera completamente la memoria usada por el estado de la política.
 void algorithms_free(Simulator *sim) {
-	if (!sim || !sim->alg_state) {
+	if (!sim) {
 		return;
 	}
-	AlgorithmState *state = get_state(sim);
-	free(state->fifo_queue.data);
-	free(state);
+	if (sim->policy && sim->policy->free) {
+		sim->policy->free(sim, sim->alg_state);
+	}
 	sim->alg_state = NULL;
 }
 
 // Actualiza la política elegida cuando una página se carga en RAM.
-void algorithms_on_page_loaded(Simulator *sim, Page *page) {
-	if (!sim || !page) {
-		return;
-	}
-	AlgorithmState *state = get_state(sim);
-	if (!state) {
+void algorithms_on_page_loaded(Simulator *sim, sim_pageid_t page_id) {
+	if (!sim || !page_id || !sim->policy || !sim->policy->on_loaded) {
 		return;
 	}
-	switch (sim->algorithm) {
-		case ALG_FIFO:
-			queue_push(&state->fifo_queue, page->id);
-			break;
-		case ALG_OPT:
-			opt_refresh_next_use(page);
-			break;
-		case ALG_SC:
-		case ALG_MRU:
-		case ALG_RND:
-		default:
-			if (sim->algorithm == ALG_OPT) {
-				opt_refresh_next_use(page);
-			}
-			break;
+	int frame = sim->mmu.pages.frame_index[page_id];
+	if (frame >= 0) {
+		sim->policy->on_loaded(sim, sim->alg_state, page_id, frame);
 	}
 }
 
-// Notifica que una página dejó la memoria física para sincronizar el algoritmo.
-void algorithms_on_page_evicted(Simulator *sim, Page *page) {
-	if (!sim || !page) {
+// Notifica que una página dejó la memoria física para sincronizar la política.
+void algorithms_on_page_evicted(Simulator *sim, sim_pageid_t page_id) {
+	if (!sim || !page_id || !sim->policy || !sim->policy->on_evicted) {
 		return;
 	}
-	if (sim->algorithm == ALG_OPT) {
-		opt_refresh_next_use(page);
+	int frame = sim->mmu.pages.frame_index[page_id];
+	if (frame >= 0) {
+		sim->policy->on_evicted(sim, sim->alg_state, page_id, frame);
 	}
 }
 
 // Marca el acceso a página para que cada política ajuste sus indicadores.
-void algorithms_on_page_accessed(Simulator *sim, Page *page) {
-	if (!sim || !page) {
+void algorithms_on_page_accessed(Simulator *sim, sim_pageid_t page_id) {
+	if (!sim || !page_id || !sim->policy || !sim->policy->on_accessed) {
 		return;
 	}
-	if (sim->algorithm == ALG_OPT) {
-		opt_advance_future_use(page);
+	int frame = sim->mmu.pages.frame_index[page_id];
+	if (frame >= 0) {
+		sim->policy->on_accessed(sim, sim->alg_state, page_id, frame);
 	}
 }
 
 // Punto de entrada que invoca la política de reemplazo configurada.
 sim_pageid_t choose_victim(Simulator *sim) {
-	if (!sim) {
+	if (!sim || !sim->policy || !sim->policy->choose) {
 		return 0;
 	}
-	AlgorithmState *state = get_state(sim);
+	return sim->policy->choose(sim, sim->alg_state);
+}
 
-	switch (sim->algorithm) {
-		case ALG_FIFO:
-			return fifo_choose(sim, state);
-		case ALG_SC:
-			return sc_choose(sim, state);
-		case ALG_LRU:
-			return lru_choose(sim);
-		case ALG_MRU:
-			return mru_choose(sim);
-		case ALG_RND:
-			return rnd_choose(sim);
-		case ALG_OPT:
-			return opt_choose(sim);
-		default:
+// Consulta el bit de referencia de una página; la política puede llevar el suyo propio.
+int algorithms_page_referenced(const Simulator *sim, sim_pageid_t page_id) {
+	if (!sim || !page_exists(sim, page_id)) {
+		return 0;
+	}
+	const PageTable *pt = &sim->mmu.pages;
+	if (sim->policy && sim->policy->referenced) {
+		int frame = pt->frame_index[page_id];
+		if (!pt->in_ram[page_id] || frame < 0) {
 			return 0;
+		}
+		return sim->policy->referenced(sim, sim->alg_state, page_id, frame);
 	}
+	return pt->ref_bit[page_id];
 }
@@ -0,0 +1,592 @@
+#include "config.h"
+#include "event_stream.h"
+#include "instr_parser.h"
+#include "mrc.h"
+#include "pipeline.h"
+#include "replacement_policy.h"
+#include "sim_engine.h"
+#include "sim_manager.h"
+#include "trace_file.h"
+#include "trace_pack.h"
+#include "util.h"
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Algoritmos que se pueden pedir con -a además del simulador OPT.
+#define BENCH_MAX_SIMS 16
+
+// Devuelve el tiempo monotónico actual en segundos.
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Traduce el nombre o número del algoritmo recibido por línea de comandos.
+static int parse_algorithm(const char *text, AlgorithmType *out) {
+    static const struct {
+        const char *name;
+        AlgorithmType type;
+    } names[] = {
+        {"opt", ALG_OPT}, {"fifo", ALG_FIFO}, {"sc", ALG_SC},
+        {"lru", ALG_LRU}, {"mru", ALG_MRU},   {"rnd", ALG_RND},
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (strcmp(text, names[i].name) == 0) {
+            *out = names[i].type;
+            return 1;
+        }
+    }
+    char *end = NULL;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value < ALG_OPT || value > ALG_RND) {
+        return 0;
+    }
+    *out = (AlgorithmType)value;
+    return 1;
+}
+
+static const char *algorithm_label(AlgorithmType type) {
+    switch (type) {
+        case ALG_OPT:
+            return "OPT";
+        case ALG_FIFO:
+            return "FIFO";
+        case ALG_SC:
+            return "Second Chance";
+        case ALG_LRU:
+            return "LRU";
+        case ALG_MRU:
+            return "MRU";
+        case ALG_RND:
+            return "Random";
+        default:
+            return "Unknown";
+    }
+}
+
+// Imprime las estadísticas finales de un simulador.
+static void print_sim_stats(const Simulator *sim) {
+    const char *label = algorithm_label(sim->algorithm);
+    if (sim->algorithm == ALG_CUSTOM && sim->policy) {
+        label = sim->policy->name;
+    }
+    printf("[%s] %s\n", sim->name, label);
+    printf("  instructions      %zu\n", sim->stats.total_instructions);
+    printf("  page faults       %zu\n", sim->stats.page_faults);
+    printf("  page hits         %zu\n", sim->stats.page_hits);
+    printf("  pages created     %zu\n", sim->stats.pages_created);
+    printf("  pages evicted     %zu\n", sim->stats.pages_evicted);
+    printf("  ptr allocations   %zu\n", sim->stats.ptr_allocations);
+    printf("  ptr deletions     %zu\n", sim->stats.ptr_deletions);
+    printf("  bytes requested   %zu\n", sim->stats.bytes_requested);
+    printf("  fragmentation     %zu B\n", sim->internal_fragmentation_bytes);
+    printf("  clock             %llu\n", (unsigned long long)sim->clock);
+    printf("  thrashing         %llu\n", (unsigned long long)sim->thrashing_time);
+    printf("  pages in swap     %zu\n", sim->total_pages_in_swap);
+
+    SimMemoryStats mem;
+    sim_get_memory_stats(sim, &mem);
+    printf("  arena             %zu B reserved, %zu B high-water\n", mem.arena_reserved, mem.arena_high_water);
+    printf("  live peak         %zu ptrs, %zu processes\n", mem.ptrmaps_peak, mem.processes_peak);
+    printf("  page table        %zu B\n", mem.page_table_bytes);
+    printf("  frame table       %zu B\n", mem.frame_table_bytes);
+}
+
+// Imprime la curva de fallas completa: una línea por cantidad de marcos hasta que deja de cambiar.
+static void print_miss_curve(const char *label, const MissRatioCurve *curve) {
+    printf("[MRC] %s\n", label);
+    printf("  frames  faults  hits  miss_ratio\n");
+    for (size_t k = 1; k <= curve->points; ++k) {
+        size_t faults = curve->faults[k];
+        size_t hits = curve->access_count > faults ? curve->access_count - faults : 0;
+        double ratio = curve->access_count ? (double)faults / (double)curve->access_count : 0.0;
+        printf("  %.0f  %zu  %zu  %.6f\n", (double)k * curve->frame_step, faults, hits, ratio);
+    }
+}
+
+// Fuente de instrucciones en memoria para el modo ventana (cargas generadas o trazas binarias).
+typedef struct ArraySource {
+    const Instruction *items;
+    size_t count;
+    size_t next;
+} ArraySource;
+
+static int array_source_next(void *ctx, Instruction *out) {
+    ArraySource *source = ctx;
+    if (source->next >= source->count) {
+        return 0;
+    }
+    *out = source->items[source->next++];
+    return 1;
+}
+
+static int reader_source_next(void *ctx, Instruction *out) {
+    return instr_reader_next(ctx, out);
+}
+
+static int pack_source_next(void *ctx, Instruction *out) {
+    return trace_pack_reader_next(ctx, out);
+}
+
+// Carga de trabajo de -f (texto, binaria o comprimida, según la firma) o generada.
+// Materializada queda en items/count; en streaming se consume por source/source_ctx.
+typedef struct Workload {
+    Instruction *items;
+    size_t count;
+    Instruction *owned;          // arreglo propio (texto, generada o descomprimida)
+    TraceFile binary;
+    TracePack pack;
+    TracePackReader pack_reader;
+    InstrReader *reader;
+    ArraySource array;
+    InstrSourceFn source;
+    void *source_ctx;
+} Workload;
+
+static void workload_close(Workload *w) {
+    free(w->owned);
+    trace_file_close(&w->binary);
+    trace_pack_reader_free(&w->pack_reader);
+    trace_pack_close(&w->pack);
+    instr_reader_close(w->reader);
+    memset(w, 0, sizeof(*w));
+}
+
+// Abre la carga; con streaming las trazas de texto y comprimidas se leen a medida que se piden
+// (una instrucción o un bloque por vez). Devuelve 0 o -1 con el error ya informado.
+static int workload_open(Workload *w, const char *trace_path, const Config *cfg, int streaming) {
+    memset(w, 0, sizeof(*w));
+    if (trace_path && trace_file_is_binary(trace_path)) {
+        // Los registros mapeados se usan tal cual, también como fuente en streaming
+        if (trace_file_open(&w->binary, trace_path) != 0) {
+            return -1;
+        }
+        w->items = w->binary.instructions;
+        w->count = w->binary.count;
+    } else if (trace_path && trace_pack_is_packed(trace_path)) {
+        if (trace_pack_open(&w->pack, trace_path) != 0) {
+            return -1;
+        }
+        if (streaming) {
+            trace_pack_reader_init(&w->pack_reader, &w->pack);
+            w->source = pack_source_next;
+            w->source_ctx = &w->pack_reader;
+            return 0;
+        }
+        w->owned = trace_pack_decode_all(&w->pack, 0);
+        w->count = w->owned ? w->pack.count : 0;
+    } else if (trace_path && streaming) {
+        w->reader = instr_reader_open(trace_path);
+        if (!w->reader) {
+            fprintf(stderr, "Cannot open %s\n", trace_path);
+            return -1;
+        }
+        w->source = reader_source_next;
+        w->source_ctx = w->reader;
+        return 0;
+    } else if (trace_path) {
+        w->owned = parse_instructions_from_file(trace_path, &w->count);
+    } else {
+        w->owned = generate_instructions(cfg->process_count, cfg->op_count, cfg->seed, &w->count);
+    }
+    if (w->owned) {
+        w->items = w->owned;
+    }
+    if (!w->items || w->count == 0) {
+        fprintf(stderr, "No instructions loaded%s%s\n", trace_path ? " from " : "", trace_path ? trace_path : "");
+        workload_close(w);
+        return -1;
+    }
+    if (streaming) {
+        w->array = (ArraySource){w->items, w->count, 0};
+        w->source = array_source_next;
+        w->source_ctx = &w->array;
+    }
+    return 0;
+}
+
+// Pasa una instrucción por el traductor y entrega sus accesos y liberaciones al muestreador.
+static void feed_sampler(EventBuilder *builder, ShardsSampler *sampler, const Instruction *ins) {
+    PageSpan span = event_builder_next(builder, ins);
+    for (uint32_t p = 0; p < span.num_pages; ++p) {
+        shards_access(sampler, span.first_page + p);
+    }
+    for (size_t r = 0; r < builder->released_count; ++r) {
+        for (uint32_t p = 0; p < builder->released[r].num_pages; ++p) {
+            shards_release(sampler, builder->released[r].first_page + p);
+        }
+    }
+}
+
+// Curva muestreada en streaming: lee la traza instrucción por instrucción sin guardarla ni precomputar
+// eventos, así que sirve para trazas que no caben en memoria.
+static int run_sampled_curve(const char *trace_path, const Config *cfg, size_t page_size, double rate) {
+    ShardsSampler *sampler = shards_create(rate);
+    if (!sampler) {
+        fprintf(stderr, "Sampling rate must be in (0, 1]\n");
+        return EXIT_FAILURE;
+    }
+    // Sin reciclar ids: el muestreo espacial elige páginas por id y cada página necesita uno propio
+    EventBuilder builder;
+    event_builder_init(&builder, page_size, PAGE_ALLOC_NO_REUSE);
+
+    size_t count = 0;
+    int status = 0;
+    double start = now_seconds();
+    Workload workload;
+    if (workload_open(&workload, trace_path, cfg, 1) == 0) {
+        Instruction ins;
+        while ((status = workload.source(workload.source_ctx, &ins)) > 0) {
+            feed_sampler(&builder, sampler, &ins);
+            count++;
+        }
+        workload_close(&workload);
+    } else {
+        status = -1;
+    }
+    double curve_time = now_seconds() - start;
+
+    if (status < 0 || count == 0) {
+        fprintf(stderr, "No instructions loaded%s%s\n", trace_path ? " from " : "", trace_path ? trace_path : "");
+        event_builder_free(&builder);
+        shards_destroy(sampler);
+        return EXIT_FAILURE;
+    }
+
+    MissRatioCurve curve;
+    shards_finish(sampler, &curve);
+    if (trace_path) {
+        printf("workload          %s\n", trace_path);
+    } else {
+        config_print(cfg);
+    }
+    printf("page size         %zu B\n", builder.page_size);
+    printf("instructions      %zu\n", count);
+    printf("page events       %zu\n", curve.access_count);
+    printf("sampling rate     %g\n", rate);
+    printf("curve time        %.6f s\n", curve_time);
+    print_miss_curve("LRU (sampled)", &curve);
+
+    mrc_free(&curve);
+    event_builder_free(&builder);
+    shards_destroy(sampler);
+    return EXIT_SUCCESS;
+}
+
+// Carga la traza (o genera la carga) y la guarda en formato binario o comprimido para recargarla sin parsear.
+static int convert_trace(const char *trace_path, const Config *cfg, const char *out_path, int packed) {
+    double start = now_seconds();
+    Workload workload;
+    if (workload_open(&workload, trace_path, cfg, 0) != 0) {
+        return EXIT_FAILURE;
+    }
+    double load_time = now_seconds() - start;
+
+    start = now_seconds();
+    int status = packed ? trace_pack_save(out_path, workload.items, workload.count, 0)
+                        : trace_file_save(out_path, workload.items, workload.count);
+    double save_time = now_seconds() - start;
+    size_t count = workload.count;
+    workload_close(&workload);
+    if (status != 0) {
+        return EXIT_FAILURE;
+    }
+    printf("wrote             %s\n", out_path);
+    printf("instructions      %zu\n", count);
+    printf("load time         %.6f s\n", load_time);
+    printf("save time         %.6f s\n", save_time);
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-a alg]... [-f trace] [-p processes] [-n ops] [-s seed] [-r seed] [-F frames] [-S page_size] [-P module.so] [-j threads] [-M lru|opt] [-R rate] [-W events] [-L] [-o out.bin] [-c out.pack]\n"
+            "  -a alg   algorithm to compare against OPT: fifo|sc|lru|mru|rnd|opt or 0-5; repeat to add simulators\n"
+            "  -f path  load the workload from a trace file (text, binary or compressed, detected by its header; - reads text from stdin) instead of generating it\n"
+            "  -p N     processes for the generated workload\n"
+            "  -n N     operations for the generated workload\n"
+            "  -s N     seed for the generated workload\n"
+            "  -r N     seed for the Random replacement policy (default 0)\n"
+            "  -F N     RAM frames per simulator (default %d)\n"
+            "  -S N     page size in bytes (default %d)\n"
+            "  -P path  load a replacement policy module and compare it against OPT instead of -a (not with -a or -M)\n"
+            "  -j N     simulation threads (default one per simulator, 1 = sequential)\n"
+            "  -M alg   lru or opt: print the fault count for every frame count in one pass instead of simulating\n"
+            "  -R rate  with -M lru, stream the trace and sample this fraction of pages (SHARDS) for bounded memory\n"
+            "  -W N     stream the trace and give OPT only the next N page events (at least N, at most 2N) of lookahead;\n"
+            "           memory follows N and the live pointers and pages, not the trace length\n"
+            "  -L       with -W, read and translate the trace in their own threads, connected to the simulators by\n"
+            "           fixed-size rings (same memory bound as -W)\n"
+            "  -o path  write the workload as a binary trace and exit\n"
+            "  -c path  write the workload as a compressed (delta + varint) trace and exit\n",
+            prog, DEFAULT_RAM_FRAMES, DEFAULT_PAGE_SIZE);
+}
+
+// Punto de entrada del runner sin interfaz: simula una carga completa y mide el throughput.
+int main(int argc, char **argv) {
+    Config cfg;
+    config_load_defaults(&cfg);
+
+    const char *trace_path = NULL;
+    AlgorithmType algorithms[BENCH_MAX_SIMS];
+    size_t algorithm_count = 0;
+    size_t thread_count = 0;
+    size_t frame_count = DEFAULT_RAM_FRAMES;
+    size_t page_size = DEFAULT_PAGE_SIZE;
+    uint64_t rng_seed = 0;
+    const char *policy_path = NULL;
+    const char *curve_policy = NULL;
+    double sample_rate = 0.0;
+    size_t window = 0;
+    const char *binary_out = NULL;
+    const char *packed_out = NULL;
+    int pipelined = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "a:f:p:n:s:r:F:S:P:j:M:R:W:Lo:c:h")) != -1) {
+        switch (opt) {
+            case 'a':
+                if (algorithm_count == BENCH_MAX_SIMS) {
+                    fprintf(stderr, "At most %d algorithms can be compared\n", BENCH_MAX_SIMS);
+                    return EXIT_FAILURE;
+                }
+                if (!parse_algorithm(optarg, &algorithms[algorithm_count])) {
+                    fprintf(stderr, "Unknown algorithm '%s'\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                algorithm_count++;
+                break;
+            case 'M':
+                if (strcmp(optarg, "lru") != 0 && strcmp(optarg, "opt") != 0) {
+                    fprintf(stderr, "Miss-ratio curves are available for: lru, opt\n");
+                    return EXIT_FAILURE;
+                }
+                curve_policy = optarg;
+                break;
+            case 'R':
+                sample_rate = strtod(optarg, NULL);
+                if (!(sample_rate > 0.0 && sample_rate <= 1.0)) {
+                    fprintf(stderr, "Sampling rate must be in (0, 1]\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'W':
+                window = (size_t)strtoull(optarg, NULL, 10);
+                if (window == 0) {
+                    fprintf(stderr, "Lookahead window must be at least 1 page event\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'L':
+                pipelined = 1;
+                break;
+            case 'j':
+                thread_count = (size_t)strtoull(optarg, NULL, 10);
+                break;
+            case 'f':
+                trace_path = optarg;
+                break;
+            case 'p':
+                cfg.process_count = atoi(optarg);
+                break;
+            case 'n':
+                cfg.op_count = atoi(optarg);
+                break;
+            case 's':
+                cfg.seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                rng_seed = (uint64_t)strtoull(optarg, NULL, 10);
+                break;
+            case 'F':
+                frame_count = (size_t)strtoull(optarg, NULL, 10);
+                break;
+            case 'S':
+                page_size = (size_t)strtoull(optarg, NULL, 10);
+                break;
+            case 'P':
+                policy_path = optarg;
+                break;
+            case 'o':
+                binary_out = optarg;
+                break;
+            case 'c':
+                packed_out = optarg;
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    // El módulo de -P ocupa el lugar de -a y las curvas de -M no simulan políticas cargadas
+    if (policy_path && algorithm_count > 0) {
+        fprintf(stderr, "-P replaces -a; the two cannot be combined\n");
+        return EXIT_FAILURE;
+    }
+    if (policy_path && curve_policy) {
+        fprintf(stderr, "-P cannot be combined with -M\n");
+        return EXIT_FAILURE;
+    }
+    if (algorithm_count == 0) {
+        algorithms[algorithm_count++] = (AlgorithmType)cfg.algorithm;
+    }
+
+    if (binary_out && packed_out) {
+        fprintf(stderr, "-o and -c are mutually exclusive\n");
+        return EXIT_FAILURE;
+    }
+    if (binary_out || packed_out) {
+        return convert_trace(trace_path, &cfg, packed_out ? packed_out : binary_out, packed_out != NULL);
+    }
+
+    if (curve_policy && window) {
+        fprintf(stderr, "-W cannot be combined with -M\n");
+        return EXIT_FAILURE;
+    }
+    if (sample_rate > 0.0 && !curve_policy) {
+        fprintf(stderr, "-R requires -M lru\n");
+        return EXIT_FAILURE;
+    }
+
+    if (pipelined && !window) {
+        fprintf(stderr, "-L requires -W\n");
+        return EXIT_FAILURE;
+    }
+
+    if (curve_policy && sample_rate > 0.0) {
+        // OPT necesita los usos futuros de toda la traza, así que no admite streaming
+        if (strcmp(curve_policy, "lru") != 0) {
+            fprintf(stderr, "Sampled curves (-R) are only available for -M lru\n");
+            return EXIT_FAILURE;
+        }
+        return run_sampled_curve(trace_path, &cfg, page_size, sample_rate);
+    }
+
+    const ReplacementPolicy *user_policy = NULL;
+    if (policy_path) {
+        char err[256];
+        user_policy = policy_load_module(policy_path, err, sizeof(err));
+        if (!user_policy) {
+            fprintf(stderr, "Cannot load policy module: %s\n", err);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // En modo ventana las trazas de texto y comprimidas se leen durante la simulación
+    double load_start = now_seconds();
+    Workload workload;
+    if (workload_open(&workload, trace_path, &cfg, window != 0) != 0) {
+        policy_unload_modules();
+        return EXIT_FAILURE;
+    }
+    double load_time = now_seconds() - load_start;
+
+    SimManager mgr;
+    Pipeline *pipeline = NULL;
+    double prep_start = now_seconds();
+    if (pipelined) {
+        // Lectura y traducción en sus propios hilos; el administrador solo arma ventanas y simula
+        pipeline = pipeline_start(workload.source, workload.source_ctx, page_size, window, PIPELINE_DEFAULT_RING);
+        sim_manager_init_translated(&mgr, pipeline_next, pipeline, algorithms[0], frame_count, page_size, window);
+    } else if (window) {
+        sim_manager_init_windowed(&mgr, workload.source, workload.source_ctx, algorithms[0], frame_count, page_size,
+                                  window);
+    } else {
+        sim_manager_init_with_memory(&mgr, workload.items, workload.count, algorithms[0], frame_count, page_size);
+    }
+    double prep_time = now_seconds() - prep_start;
+    if (curve_policy) {
+        MissRatioCurve curve;
+        double curve_start = now_seconds();
+        int curve_opt = strcmp(curve_policy, "opt") == 0;
+        if (curve_opt) {
+            mrc_build_opt(&mgr, &curve);
+        } else {
+            mrc_build_lru(&mgr, &curve);
+        }
+        double curve_time = now_seconds() - curve_start;
+        if (trace_path) {
+            printf("workload          %s\n", trace_path);
+        } else {
+            config_print(&cfg);
+        }
+        printf("page size         %zu B\n", mgr.page_size);
+        printf("instructions      %zu\n", mgr.instr_count);
+        printf("page events       %zu\n", mgr.event_count);
+        printf("load time         %.6f s\n", load_time);
+        printf("preprocess time   %.6f s\n", prep_time);
+        printf("curve time        %.6f s\n", curve_time);
+        print_miss_curve(curve_opt ? "OPT" : "LRU", &curve);
+        mrc_free(&curve);
+        sim_manager_free(&mgr);
+        policy_unload_modules();
+        workload_close(&workload);
+        return EXIT_SUCCESS;
+    }
+
+    for (size_t i = 1; i < algorithm_count; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "USER%zu", i + 1);
+        sim_manager_add_simulator(&mgr, name, algorithms[i]);
+    }
+    if (user_policy) {
+        sim_set_policy(mgr.sim_user, user_policy);
+    }
+    for (size_t i = 0; i < mgr.sim_count; ++i) {
+        sim_set_rng_seed(mgr.sims[i], rng_seed);
+    }
+
+    double run_start = now_seconds();
+    sim_manager_run(&mgr, thread_count);
+    double run_time = now_seconds() - run_start;
+
+    // En modo ventana la cuenta incluye lo ya descartado; el error de lectura ya se informó
+    size_t total_instructions = mgr.instr_base + mgr.instr_count;
+    size_t total_events = mgr.event_base + mgr.event_count;
+    if (mgr.source_error || total_instructions == 0) {
+        if (!mgr.source_error) {
+            fprintf(stderr, "No instructions loaded from %s\n", trace_path);
+        }
+        sim_manager_free(&mgr);
+        pipeline_stop(pipeline);
+        workload_close(&workload);
+        policy_unload_modules();
+        return EXIT_FAILURE;
+    }
+
+    if (trace_path) {
+        printf("workload          %s\n", trace_path);
+    } else {
+        config_print(&cfg);
+    }
+    printf("memory            %zu frames x %zu B\n", mgr.frame_count, mgr.page_size);
+    printf("instructions      %zu\n", total_instructions);
+    printf("page events       %zu\n", total_events);
+    if (window) {
+        printf("lookahead window  %zu page events\n", mgr.window);
+    }
+    if (pipeline) {
+        printf("pipeline          reader + translator threads, %d-slot rings\n", PIPELINE_DEFAULT_RING);
+    }
+    printf("load time         %.6f s\n", load_time);
+    printf("preprocess time   %.6f s\n", prep_time);
+    printf("simulate time     %.6f s\n", run_time);
+    if (run_time > 0.0) {
+        printf("throughput        %.0f instr/s, %.0f page events/s\n",
+               (double)total_instructions / run_time, (double)total_events / run_time);
+    }
+    for (size_t i = 0; i < mgr.sim_count; ++i) {
+        print_sim_stats(mgr.sims[i]);
+    }
+
+    sim_manager_free(&mgr);
+    pipeline_stop(pipeline);
+    workload_close(&workload);
+    policy_unload_modules();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include "event_stream.h"
+#include "util.h"
+
+#include <string.h>
+
+// Variante de realloc que aborta si la reserva falla.
+static void *stream_realloc(void *ptr, size_t size) {
+    void *tmp = realloc(ptr, size);
+    if (!tmp && size != 0) {
+        fprintf(stderr, "Out of memory (event_stream realloc)\n");
+        exit(EXIT_FAILURE);
+    }
+    return tmp;
+}
+
+static uint64_t span_pack(PageSpan span) {
+    return (uint64_t)span.first_page | ((uint64_t)span.num_pages << 32);
+}
+
+static PageSpan span_unpack(uint64_t value) {
+    PageSpan span = {(sim_pageid_t)value, (uint32_t)(value >> 32)};
+    return span;
+}
+
+// Devuelve el proceso pid, ampliando la tabla si hace falta.
+static StreamProcess *builder_process(EventBuilder *builder, sim_pid_t pid) {
+    size_t needed = (size_t)pid + 1;
+    if (needed > builder->process_capacity) {
+        size_t new_capacity = builder->process_capacity ? builder->process_capacity * 2 : 16;
+        while (new_capacity < needed) {
+            new_capacity *= 2;
+        }
+        builder->processes = stream_realloc(builder->processes, new_capacity * sizeof(StreamProcess));
+        memset(builder->processes + builder->process_capacity, 0,
+               (new_capacity - builder->process_capacity) * sizeof(StreamProcess));
+        builder->process_capacity = new_capacity;
+    }
+    return &builder->processes[pid];
+}
+
+// Anota un rango liberado por la instrucción actual y devuelve sus ids al asignador.
+static void builder_release(EventBuilder *builder, PageSpan span) {
+    page_alloc_release(&builder->page_ids, span.first_page, span.num_pages);
+    if (builder->released_count == builder->released_capacity) {
+        builder->released_capacity = builder->released_capacity ? builder->released_capacity * 2 : 16;
+        builder->released = stream_realloc(builder->released, builder->released_capacity * sizeof(PageSpan));
+    }
+    builder->released[builder->released_count++] = span;
+}
+
+void event_builder_init(EventBuilder *builder, size_t page_size, size_t reuse_distance) {
+    memset(builder, 0, sizeof(*builder));
+    builder->page_size = page_size ? page_size : DEFAULT_PAGE_SIZE;
+    page_alloc_init(&builder->page_ids, reuse_distance);
+    id_map_init(&builder->ptrs);
+}
+
+PageSpan event_builder_next(EventBuilder *builder, const Instruction *ins) {
+    PageSpan none = {0, 0};
+    builder->released_count = 0;
+
+    switch (ins->type) {
+        case INS_NEW: {
+            size_t num_pages = (ins->size + builder->page_size - 1) / builder->page_size;
+            if (num_pages == 0) {
+                num_pages = 1;
+            }
+            // Mismo asignador que el motor, así los ids coinciden
+            PageSpan span = {page_alloc_take(&builder->page_ids, (uint32_t)num_pages), (uint32_t)num_pages};
+            id_map_put(&builder->ptrs, ins->ptr_id, span_pack(span));
+
+            StreamProcess *proc = builder_process(builder, ins->pid);
+            if (proc->count == proc->capacity) {
+                proc->capacity = proc->capacity ? proc->capacity * 2 : 4;
+                proc->ptrs = stream_realloc(proc->ptrs, proc->capacity * sizeof(sim_ptr_t));
+            }
+            proc->ptrs[proc->count++] = ins->ptr_id;
+            return span;
+        }
+        case INS_USE: {
+            uint64_t *value = id_map_find(&builder->ptrs, ins->ptr_id);
+            return value ? span_unpack(*value) : none;
+        }
+        case INS_DELETE: {
+            uint64_t *value = id_map_find(&builder->ptrs, ins->ptr_id);
+            if (!value) {
+                return none;
+            }
+            builder_release(builder, span_unpack(*value));
+            id_map_remove(&builder->ptrs, ins->ptr_id);
+            if (ins->pid < builder->process_capacity) {
+                StreamProcess *proc = &builder->processes[ins->pid];
+                for (size_t i = 0; i < proc->count; ++i) {
+                    if (proc->ptrs[i] == ins->ptr_id) {
+                        proc->ptrs[i] = proc->ptrs[--proc->count];
+                        break;
+                    }
+                }
+            }
+            return none;
+        }
+        case INS_KILL: {
+            if (ins->pid >= builder->process_capacity) {
+                return none;
+            }
+            StreamProcess *proc = &builder->processes[ins->pid];
+            for (size_t i = 0; i < proc->count; ++i) {
+                uint64_t *value = id_map_find(&builder->ptrs, proc->ptrs[i]);
+                if (value) {
+                    builder_release(builder, span_unpack(*value));
+                    id_map_remove(&builder->ptrs, proc->ptrs[i]);
+                }
+            }
+            free(proc->ptrs);
+            memset(proc, 0, sizeof(*proc));
+            return none;
+        }
+        default:
+            return none;
+    }
+}
+
+void event_builder_free(EventBuilder *builder) {
+    id_map_free(&builder->ptrs);
+    page_alloc_free(&builder->page_ids);
+    for (size_t i = 0; i < builder->process_capacity; ++i) {
+        free(builder->processes[i].ptrs);
+    }
+    free(builder->processes);
+    free(builder->released);
+    memset(builder, 0, sizeof(*builder));
+}
@@ -0,0 +1,104 @@
+#include "id_map.h"
+#include "util.h"
+
+#include <string.h>
+
+#define ID_MAP_MIN_CAPACITY 64
+
+// Posición inicial de la clave dentro de la tabla.
+static size_t id_map_slot(const IdMap *map, uint32_t key) {
+    return (size_t)mix_u64(key) & (map->capacity - 1);
+}
+
+// Reserva una tabla de capacity huecos y reinserta las claves existentes.
+static void id_map_rehash(IdMap *map, size_t capacity) {
+    uint32_t *old_keys = map->keys;
+    uint64_t *old_values = map->values;
+    size_t old_capacity = map->capacity;
+
+    map->keys = xmalloc(capacity * sizeof(uint32_t));
+    map->values = xmalloc(capacity * sizeof(uint64_t));
+    memset(map->keys, 0, capacity * sizeof(uint32_t));
+    map->capacity = capacity;
+    map->count = 0;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_keys[i]) {
+            id_map_put(map, old_keys[i], old_values[i]);
+        }
+    }
+    free(old_keys);
+    free(old_values);
+}
+
+void id_map_init(IdMap *map) {
+    memset(map, 0, sizeof(*map));
+}
+
+uint64_t *id_map_find(const IdMap *map, uint32_t key) {
+    if (!key || map->capacity == 0) {
+        return NULL;
+    }
+    for (size_t i = id_map_slot(map, key);; i = (i + 1) & (map->capacity - 1)) {
+        if (map->keys[i] == key) {
+            return &map->values[i];
+        }
+        if (!map->keys[i]) {
+            return NULL;
+        }
+    }
+}
+
+void id_map_put(IdMap *map, uint32_t key, uint64_t value) {
+    if (!key) {
+        return;
+    }
+    // Mantiene la carga por debajo de 1/2 para que los sondeos lineales sean cortos
+    if ((map->count + 1) * 2 > map->capacity) {
+        id_map_rehash(map, map->capacity ? map->capacity * 2 : ID_MAP_MIN_CAPACITY);
+    }
+    size_t i = id_map_slot(map, key);
+    while (map->keys[i] && map->keys[i] != key) {
+        i = (i + 1) & (map->capacity - 1);
+    }
+    if (!map->keys[i]) {
+        map->keys[i] = key;
+        map->count++;
+    }
+    map->values[i] = value;
+}
+
+// Borra con desplazamiento hacia atrás: no deja marcas de borrado que alarguen los sondeos.
+int id_map_remove(IdMap *map, uint32_t key) {
+    if (!key || map->capacity == 0) {
+        return 0;
+    }
+    size_t mask = map->capacity - 1;
+    size_t i = id_map_slot(map, key);
+    while (map->keys[i] != key) {
+        if (!map->keys[i]) {
+            return 0;
+        }
+        i = (i + 1) & mask;
+    }
+
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; map->keys[j]; j = (j + 1) & mask) {
+        size_t home = id_map_slot(map, map->keys[j]);
+        // La clave en j puede ocupar el hueco si su posición inicial no está entre hole y j
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            map->keys[hole] = map->keys[j];
+            map->values[hole] = map->values[j];
+            hole = j;
+        }
+    }
+    map->keys[hole] = 0;
+    map->count--;
+    return 1;
+}
+
+void id_map_free(IdMap *map) {
+    free(map->keys);
+    free(map->values);
+    memset(map, 0, sizeof(*map));
+}
@@ -1,19 +1,25 @@
 #include "instr_parser.h"
+#include "id_map.h"
 #include "util.h"
 
-#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-typedef struct {
-    sim_pid_t owner_pid;
-    int alive;
-} PtrInfo;
+// Bytes mínimos por tramo para analizar en paralelo; por debajo no compensa lanzar hilos.
+#define PARSE_MIN_CHUNK (1u << 20)
+// Ids de puntero mínimos en la ventana densa de PtrTable.
+#define PTR_WINDOW_MIN 1024
 
 typedef struct {
     int seen;
     int killed;
+    size_t live;             // punteros vivos; al terminar el proceso pasan a ser entradas vencidas
 } ProcessInfo;
 
 typedef struct {
@@ -71,23 +77,6 @@ static void process_remove_ptr(GenProcess *proc, size_t index) {
     --proc->count;
 }
 
-// Amplía el vector de punteros rastreados si el id requerido no cabe.
-static void ensure_ptr_capacity(PtrInfo **ptrs, size_t *capacity, size_t needed) {
-    if (needed <= *capacity) {
-        return;
-    }
-    size_t new_capacity = (*capacity ? *capacity * 2 : 32);
-    while (new_capacity < needed) {
-        new_capacity *= 2;
-    }
-    *ptrs = xrealloc(*ptrs, new_capacity * sizeof(PtrInfo));
-    for (size_t i = *capacity; i < new_capacity; ++i) {
-        (*ptrs)[i].owner_pid = 0;
-        (*ptrs)[i].alive = 0;
-    }
-    *capacity = new_capacity;
-}
-
 // Garantiza espacio para registrar datos por proceso según el pid dado.
 static void ensure_process_capacity(ProcessInfo **procs, size_t *capacity, sim_pid_t pid) {
     size_t needed = (size_t)pid + 1;
@@ -99,199 +88,612 @@ static void ensure_process_capacity(ProcessInfo **procs, size_t *capacity, sim_p
         new_capacity *= 2;
     }
     *procs = xrealloc(*procs, new_capacity * sizeof(ProcessInfo));
-    for (size_t i = *capacity; i < new_capacity; ++i) {
-        (*procs)[i].seen = 0;
-        (*procs)[i].killed = 0;
-    }
+    memset(*procs + *capacity, 0, (new_capacity - *capacity) * sizeof(ProcessInfo));
     *capacity = new_capacity;
 }
 
-// Quita espacios iniciales y finales en la línea analizada.
-static void trim_whitespace(char *str) {
-    if (!str) {
-        return;
+// Espacio en blanco con la misma clase que isspace() en la configuración regional "C".
+static int is_space_char(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Entero sin signo con la misma semántica que %u/%zu de sscanf: espacios previos, signo opcional y al
+// menos un dígito; si desborda satura como strtoul y el llamador trunca al ancho del destino.
+static int scan_unsigned(const char **cursor, const char *end, uint64_t *out) {
+    const char *p = *cursor;
+    while (p < end && is_space_char(*p)) {
+        ++p;
     }
-    char *start = str;
-    while (*start && isspace((unsigned char)*start)) {
-        ++start;
+    int negative = 0;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
     }
-    if (start != str) {
-        memmove(str, start, strlen(start) + 1);
+    if (p >= end || *p < '0' || *p > '9') {
+        return 0;
     }
-    size_t len = strlen(str);
-    while (len > 0 && isspace((unsigned char)str[len - 1])) {
-        str[--len] = '\0';
+    uint64_t value = 0;
+    int overflow = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        unsigned int digit = (unsigned int)(*p - '0');
+        if (value > (UINT64_MAX - digit) / 10) {
+            overflow = 1;
+        } else {
+            value = value * 10 + digit;
+        }
     }
+    *out = overflow ? UINT64_MAX : (negative ? (uint64_t)0 - value : value);
+    *cursor = p;
+    return 1;
 }
 
-// Detecta si la línea está vacía o contiene solo un comentario.
-static int is_blank_or_comment(const char *line) {
-    for (const char *p = line; *p; ++p) {
-        if (isspace((unsigned char)*p)) {
-            continue;
-        }
-        return (*p == '#');
+// Consume el literal si la línea continúa exactamente con él.
+static int scan_literal(const char **cursor, const char *end, const char *literal, size_t length) {
+    if ((size_t)(end - *cursor) < length || memcmp(*cursor, literal, length) != 0) {
+        return 0;
     }
+    *cursor += length;
     return 1;
 }
 
-// Verifica que no existan caracteres basura después de una instrucción válida.
-static int ensure_no_trailing(const char *extra) {
-    while (*extra) {
-        if (!isspace((unsigned char)*extra)) {
-            return 0;
+// Resultado de reconocer "op(a)" o "op(a,b)" en una línea recortada.
+typedef enum {
+    SCAN_NO_MATCH,           // no coincide: se prueba el siguiente patrón
+    SCAN_MATCH,
+    SCAN_TRAILING            // los números coinciden pero sobra texto (incluido un ')' faltante)
+} ScanResult;
+
+// Reconoce literal seguido de count enteros separados por comas y ')'. Igual que sscanf con %n, si
+// los números se leyeron pero falta el ')' final todo la línea cuenta como texto sobrante.
+static ScanResult scan_call(const char *line, const char *end, const char *literal, size_t length,
+                            uint64_t *args, int count) {
+    const char *p = line;
+    if (!scan_literal(&p, end, literal, length)) {
+        return SCAN_NO_MATCH;
+    }
+    for (int i = 0; i < count; ++i) {
+        if ((i > 0 && !scan_literal(&p, end, ",", 1)) || !scan_unsigned(&p, end, &args[i])) {
+            return SCAN_NO_MATCH;
         }
-        ++extra;
     }
-    return 1;
+    return (p + 1 == end && *p == ')') ? SCAN_MATCH : SCAN_TRAILING;
 }
 
-// Comprueba que el identificador de puntero sea válido para la operación solicitada.
-static int validate_ptr(PtrInfo *ptrs, size_t ptr_capacity, sim_ptr_t ptr_id, InstrType type, FILE *stream, size_t line_no) {
-    if (ptr_id == 0 || ptr_id >= ptr_capacity || !ptrs[ptr_id].alive) {
-        const char *label = (type == INS_USE) ? "use" : "delete";
-        fprintf(stream, "Instruction parser error on line %zu: invalid pointer id %u for %s()\n",
-                line_no, ptr_id, label);
-        return 0;
+static const char *const instr_names[] = {"new", "use", "delete", "kill"};
+
+// Resultado del análisis sintáctico de una línea.
+typedef enum {
+    LINE_SKIP,               // vacía o comentario
+    LINE_INSTR,
+    LINE_TRAILING,           // instr.type indica la operación con texto sobrante
+    LINE_UNRECOGNISED
+} LineKind;
+
+// Línea reconocida solo por su sintaxis: new/kill traen pid (y size), use/delete traen ptr_id.
+// Los ids de new() y los dueños de use/delete los completa el paso semántico, que es secuencial.
+typedef struct ParsedLine {
+    LineKind kind;
+    Instruction instr;
+    const char *text;        // línea recortada, para el mensaje de error
+    int length;
+} ParsedLine;
+
+// Analiza la línea [line, end) sin tocar estado compartido, así que puede correr en cualquier hilo.
+static void parse_line(const char *line, const char *end, ParsedLine *out) {
+    while (line < end && is_space_char(*line)) {
+        ++line;
     }
-    return 1;
+    while (end > line && is_space_char(end[-1])) {
+        --end;
+    }
+    out->text = line;
+    out->length = (int)(end - line);
+    if (line == end || *line == '#') {
+        out->kind = LINE_SKIP;
+        return;
+    }
+
+    static const struct {
+        const char *literal;
+        size_t length;
+        int args;
+    } patterns[] = {{"new(", 4, 2}, {"use(", 4, 1}, {"delete(", 7, 1}, {"kill(", 5, 1}};
+
+    memset(&out->instr, 0, sizeof(out->instr));
+    for (int t = INS_NEW; t <= INS_KILL; ++t) {
+        uint64_t args[2] = {0, 0};
+        ScanResult result = scan_call(line, end, patterns[t].literal, patterns[t].length, args, patterns[t].args);
+        if (result == SCAN_NO_MATCH) {
+            continue;
+        }
+        out->instr.type = (InstrType)t;
+        out->kind = (result == SCAN_MATCH) ? LINE_INSTR : LINE_TRAILING;
+        if (t == INS_NEW || t == INS_KILL) {
+            out->instr.pid = (sim_pid_t)(unsigned int)args[0];
+            out->instr.size = (t == INS_NEW) ? (size_t)args[1] : 0;
+        } else {
+            out->instr.ptr_id = (sim_ptr_t)(unsigned int)args[0];
+        }
+        return;
+    }
+    out->kind = LINE_UNRECOGNISED;
 }
 
-// Carga instrucciones desde un archivo de texto con formato amigable.
-Instruction *parse_instructions_from_file(const char *path, size_t *count) {
-    if (count) {
-        *count = 0;
+static void report_syntax_error(const ParsedLine *parsed, size_t line_no) {
+    if (parsed->kind == LINE_TRAILING) {
+        fprintf(stderr, "Instruction parser error on line %zu: trailing characters after %s()\n", line_no,
+                instr_names[parsed->instr.type]);
+    } else {
+        fprintf(stderr, "Instruction parser error on line %zu: unrecognised instruction '%.*s'\n", line_no,
+                parsed->length, parsed->text);
     }
+}
 
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
-        return NULL;
+// Dueños de los punteros vivos. Los ids de new() son consecutivos, así que los recientes van en un
+// arreglo denso (acceso directo, como la tabla por id que reemplaza) y los que sobreviven a la
+// ventana pasan a un IdMap. La ventana se corre en vez de crecer mientras al menos la mitad de sus
+// entradas estén muertas, de modo que la memoria sigue a los punteros vivos y no al largo de la traza.
+typedef struct PtrTable {
+    sim_pid_t *window;       // dueño de los ids [base, base + length); 0 = no vive
+    size_t length;
+    size_t capacity;
+    sim_ptr_t base;
+    size_t window_live;
+    IdMap old;               // ptr_id vivo < base -> dueño
+} PtrTable;
+
+// Estado de validación que exige recorrer las instrucciones en orden. Un kill() no recorre los
+// punteros del proceso: quedan como entradas vencidas que se descartan al consultarlas y se purgan
+// cuando llegan a ser la mitad de la tabla.
+typedef struct ParseState {
+    PtrTable ptrs;
+    size_t stale;            // entradas de procesos terminados que siguen en ptrs
+    ProcessInfo *processes;
+    size_t proc_capacity;
+    sim_ptr_t next_ptr_id;
+    int resolved;            // las instrucciones ya traen ptr_id y pid: se verifican en vez de asignarse
+} ParseState;
+
+// Dueño vivo de ptr_id o 0. Las entradas de procesos terminados cuentan como muertas.
+static sim_pid_t ptr_owner(const ParseState *state, sim_ptr_t ptr_id) {
+    const PtrTable *table = &state->ptrs;
+    sim_pid_t owner = 0;
+    if (ptr_id >= table->base && ptr_id - table->base < table->length) {
+        owner = table->window[ptr_id - table->base];
+    } else if (ptr_id < table->base) {
+        const uint64_t *entry = id_map_find(&table->old, ptr_id);
+        owner = entry ? (sim_pid_t)*entry : 0;
     }
+    return (owner && !state->processes[owner].killed) ? owner : 0;
+}
 
-    InstructionBuffer buffer = {0};
-    PtrInfo *ptrs = NULL;
-    size_t ptr_capacity = 0;
-    ProcessInfo *processes = NULL;
-    size_t proc_capacity = 0;
-    sim_ptr_t next_ptr_id = 0;
+static void ptr_forget(ParseState *state, sim_ptr_t ptr_id) {
+    PtrTable *table = &state->ptrs;
+    if (ptr_id >= table->base) {
+        table->window[ptr_id - table->base] = 0;
+        table->window_live--;
+    } else {
+        id_map_remove(&table->old, ptr_id);
+    }
+}
 
-    char line[256];
-    size_t line_no = 0;
-    int ok = 1;
+// Borra de la ventana las entradas de procesos terminados y recuenta las vivas.
+static void window_sweep(ParseState *state) {
+    PtrTable *table = &state->ptrs;
+    table->window_live = 0;
+    for (size_t i = 0; i < table->length; ++i) {
+        sim_pid_t owner = table->window[i];
+        if (owner && state->processes[owner].killed) {
+            table->window[i] = 0;
+        } else if (owner) {
+            table->window_live++;
+        }
+    }
+}
 
-    while (fgets(line, sizeof(line), fp)) {
-        ++line_no;
-        trim_whitespace(line);
-        if (*line == '\0' || is_blank_or_comment(line)) {
-            continue;
+// Descarta todas las entradas vencidas: rearma el IdMap y barre la ventana.
+static void purge_killed_ptrs(ParseState *state) {
+    PtrTable *table = &state->ptrs;
+    IdMap live;
+    id_map_init(&live);
+    for (size_t i = 0; i < table->old.capacity; ++i) {
+        uint32_t key = table->old.keys[i];
+        if (key && !state->processes[table->old.values[i]].killed) {
+            id_map_put(&live, key, table->old.values[i]);
         }
+    }
+    id_map_free(&table->old);
+    table->old = live;
+    window_sweep(state);
+    state->stale = 0;
+}
 
-        Instruction instr = {0};
-        int consumed = 0;
+// Registra el siguiente id consecutivo. Con la ventana llena, si la mitad está muerta pasa los vivos
+// de la mitad más vieja al IdMap y la corre; si no, la agranda.
+static void ptr_append(ParseState *state, sim_ptr_t ptr_id, sim_pid_t owner) {
+    PtrTable *table = &state->ptrs;
+    if (table->length == 0) {
+        table->base = ptr_id;
+    }
+    if (table->length == table->capacity) {
+        window_sweep(state);
+        if (table->capacity >= PTR_WINDOW_MIN && table->window_live * 2 <= table->length) {
+            size_t shift = table->length / 2;
+            for (size_t i = 0; i < shift; ++i) {
+                if (table->window[i]) {
+                    id_map_put(&table->old, table->base + (sim_ptr_t)i, table->window[i]);
+                    table->window_live--;
+                }
+            }
+            memmove(table->window, table->window + shift, (table->length - shift) * sizeof(sim_pid_t));
+            table->length -= shift;
+            table->base += (sim_ptr_t)shift;
+        } else {
+            table->capacity = table->capacity ? table->capacity * 2 : PTR_WINDOW_MIN;
+            table->window = xrealloc(table->window, table->capacity * sizeof(sim_pid_t));
+        }
+    }
+    table->window[table->length++] = owner;
+    table->window_live++;
+}
 
-        unsigned int pid = 0;
-        size_t size = 0;
-        unsigned int ptr_raw = 0;
+typedef enum {
+    SEM_OK,
+    SEM_PROCESS_KILLED,
+    SEM_INVALID_PTR,
+    SEM_UNKNOWN_PROCESS,
+    SEM_DUPLICATE_KILL,
+    SEM_INVALID_PID,
+    SEM_SIZE_OVERFLOW,
+    SEM_WRONG_OWNER
+} SemanticError;
 
-        if (sscanf(line, "new(%u,%zu)%n", &pid, &size, &consumed) == 2) {
-            if (!ensure_no_trailing(line + consumed)) {
-                fprintf(stderr, "Instruction parser error on line %zu: trailing characters after new()\n", line_no);
-                ok = 0;
-                break;
+// Asigna el ptr_id de new(), resuelve el dueño de use/delete y valida punteros y procesos. Con
+// state->resolved exige en cambio que el ptr_id y el pid recibidos sean los que se habrían asignado.
+// Si falla, la instrucción queda como la dejó el análisis sintáctico para informar el error.
+static SemanticError apply_semantics(ParseState *state, Instruction *instr) {
+    if ((instr->type == INS_NEW || instr->type == INS_KILL) && instr->pid == 0) {
+        return SEM_INVALID_PID;
+    }
+    switch (instr->type) {
+        case INS_NEW: {
+            if ((uint64_t)instr->size > INSTR_MAX_SIZE) {
+                return SEM_SIZE_OVERFLOW;
             }
-            ensure_process_capacity(&processes, &proc_capacity, (sim_pid_t)pid);
-            ProcessInfo *proc = &processes[pid];
+            if (state->resolved && instr->ptr_id != (sim_ptr_t)(state->next_ptr_id + 1)) {
+                return SEM_INVALID_PTR;
+            }
+            ensure_process_capacity(&state->processes, &state->proc_capacity, instr->pid);
+            ProcessInfo *proc = &state->processes[instr->pid];
             if (proc->killed) {
-                fprintf(stderr, "Instruction parser error on line %zu: process %u already killed\n", line_no, pid);
-                ok = 0;
-                break;
+                return SEM_PROCESS_KILLED;
             }
             proc->seen = 1;
 
-            ++next_ptr_id;
-            ensure_ptr_capacity(&ptrs, &ptr_capacity, (size_t)next_ptr_id + 1);
-            ptrs[next_ptr_id].owner_pid = (sim_pid_t)pid;
-            ptrs[next_ptr_id].alive = 1;
-
-            instr.type = INS_NEW;
-            instr.pid = (sim_pid_t)pid;
-            instr.size = size;
-            instr.ptr_id = next_ptr_id;
-        } else if (sscanf(line, "use(%u)%n", &ptr_raw, &consumed) == 1) {
-            if (!ensure_no_trailing(line + consumed)) {
-                fprintf(stderr, "Instruction parser error on line %zu: trailing characters after use()\n", line_no);
-                ok = 0;
-                break;
-            }
-            sim_ptr_t ptr_id = (sim_ptr_t)ptr_raw;
-            if (!validate_ptr(ptrs, ptr_capacity, ptr_id, INS_USE, stderr, line_no)) {
-                ok = 0;
-                break;
-            }
-            instr.type = INS_USE;
-            instr.ptr_id = ptr_id;
-            instr.pid = ptrs[ptr_id].owner_pid;
-        } else if (sscanf(line, "delete(%u)%n", &ptr_raw, &consumed) == 1) {
-            if (!ensure_no_trailing(line + consumed)) {
-                fprintf(stderr, "Instruction parser error on line %zu: trailing characters after delete()\n", line_no);
-                ok = 0;
-                break;
+            sim_ptr_t ptr_id = ++state->next_ptr_id;
+            ptr_append(state, ptr_id, instr->pid);
+            proc->live++;
+            instr->ptr_id = ptr_id;
+            return SEM_OK;
+        }
+        case INS_USE:
+        case INS_DELETE: {
+            sim_ptr_t ptr_id = instr->ptr_id;
+            sim_pid_t owner = ptr_owner(state, ptr_id);
+            if (!owner) {
+                return SEM_INVALID_PTR;
             }
-            sim_ptr_t ptr_id = (sim_ptr_t)ptr_raw;
-            if (!validate_ptr(ptrs, ptr_capacity, ptr_id, INS_DELETE, stderr, line_no)) {
-                ok = 0;
-                break;
+            if (state->resolved && instr->pid != owner) {
+                return SEM_WRONG_OWNER;
             }
-            instr.type = INS_DELETE;
-            instr.ptr_id = ptr_id;
-            instr.pid = ptrs[ptr_id].owner_pid;
-            ptrs[ptr_id].alive = 0;
-        } else if (sscanf(line, "kill(%u)%n", &pid, &consumed) == 1) {
-            if (!ensure_no_trailing(line + consumed)) {
-                fprintf(stderr, "Instruction parser error on line %zu: trailing characters after kill()\n", line_no);
-                ok = 0;
-                break;
+            instr->pid = owner;
+            if (instr->type == INS_DELETE) {
+                ptr_forget(state, ptr_id);
+                state->processes[owner].live--;
             }
-            ensure_process_capacity(&processes, &proc_capacity, (sim_pid_t)pid);
-            ProcessInfo *proc = &processes[pid];
+            return SEM_OK;
+        }
+        case INS_KILL: {
+            ensure_process_capacity(&state->processes, &state->proc_capacity, instr->pid);
+            ProcessInfo *proc = &state->processes[instr->pid];
             if (!proc->seen) {
-                fprintf(stderr, "Instruction parser error on line %zu: kill() on unknown process %u\n", line_no, pid);
-                ok = 0;
-                break;
+                return SEM_UNKNOWN_PROCESS;
             }
             if (proc->killed) {
-                fprintf(stderr, "Instruction parser error on line %zu: duplicate kill() for process %u\n", line_no, pid);
-                ok = 0;
-                break;
+                return SEM_DUPLICATE_KILL;
             }
             proc->killed = 1;
+            // Los punteros del proceso dejan de existir, igual que en el simulador
+            state->stale += proc->live;
+            proc->live = 0;
+            if (state->stale * 2 > state->ptrs.window_live + state->ptrs.old.count) {
+                purge_killed_ptrs(state);
+            }
+            return SEM_OK;
+        }
+    }
+    return SEM_OK;
+}
 
-            instr.type = INS_KILL;
-            instr.pid = (sim_pid_t)pid;
-        } else {
-            fprintf(stderr, "Instruction parser error on line %zu: unrecognised instruction '%s'\n", line_no, line);
-            ok = 0;
+// Informa el error como "... on <place> <number>: ...", donde place es "line" o "record".
+static void report_semantic_error(SemanticError error, const Instruction *instr, const char *place, size_t number) {
+    fprintf(stderr, "Instruction parser error on %s %zu: ", place, number);
+    switch (error) {
+        case SEM_PROCESS_KILLED:
+            fprintf(stderr, "process %u already killed\n", instr->pid);
             break;
-        }
+        case SEM_INVALID_PTR:
+            fprintf(stderr, "invalid pointer id %u for %s()\n", instr->ptr_id, instr_names[instr->type]);
+            break;
+        case SEM_UNKNOWN_PROCESS:
+            fprintf(stderr, "kill() on unknown process %u\n", instr->pid);
+            break;
+        case SEM_DUPLICATE_KILL:
+            fprintf(stderr, "duplicate kill() for process %u\n", instr->pid);
+            break;
+        case SEM_INVALID_PID:
+            fprintf(stderr, "invalid process id 0 for %s()\n", instr_names[instr->type]);
+            break;
+        case SEM_SIZE_OVERFLOW:
+            fprintf(stderr, "size %llu for new() exceeds %llu\n", (unsigned long long)instr->size,
+                    (unsigned long long)INSTR_MAX_SIZE);
+            break;
+        case SEM_WRONG_OWNER:
+            fprintf(stderr, "pointer id %u for %s() does not belong to process %u\n", instr->ptr_id,
+                    instr_names[instr->type], instr->pid);
+            break;
+        case SEM_OK:
+            break;
+    }
+}
 
-        ensure_instruction_capacity(&buffer, buffer.count + 1);
-        buffer.data[buffer.count++] = instr;
+static void parse_state_free(ParseState *state) {
+    free(state->ptrs.window);
+    id_map_free(&state->ptrs.old);
+    free(state->processes);
+}
+
+struct InstrValidator {
+    ParseState state;
+    size_t record;
+};
+
+InstrValidator *instr_validator_create(void) {
+    InstrValidator *validator = xmalloc(sizeof(InstrValidator));
+    memset(validator, 0, sizeof(*validator));
+    validator->state.resolved = 1;
+    return validator;
+}
+
+int instr_validator_check(InstrValidator *validator, const Instruction *instr) {
+    Instruction copy = *instr;
+    ++validator->record;
+    if ((unsigned)copy.type > INS_KILL) {
+        fprintf(stderr, "Instruction parser error on record %zu: invalid instruction type %u\n", validator->record,
+                (unsigned)copy.type);
+        return -1;
     }
+    SemanticError error = apply_semantics(&validator->state, &copy);
+    if (error != SEM_OK) {
+        report_semantic_error(error, instr, "record", validator->record);
+        return -1;
+    }
+    return 0;
+}
 
-    fclose(fp);
+void instr_validator_free(InstrValidator *validator) {
+    if (!validator) {
+        return;
+    }
+    parse_state_free(&validator->state);
+    free(validator);
+}
 
-    free(ptrs);
-    free(processes);
+int instr_validate_all(const Instruction *list, size_t n) {
+    InstrValidator *validator = instr_validator_create();
+    int status = 0;
+    for (size_t i = 0; i < n && status == 0; ++i) {
+        status = instr_validator_check(validator, &list[i]);
+    }
+    instr_validator_free(validator);
+    return status;
+}
 
-    if (!ok) {
-        free(buffer.data);
-        if (count) {
-            *count = 0;
+// Texto de entrada: el archivo mapeado o, si no se puede mapear (tuberías, stdin), un búfer propio con
+// el archivo completo o, en streaming, una ventana que input_refill va corriendo sobre el descriptor.
+typedef struct InputText {
+    const char *data;
+    size_t size;
+    int mapped;
+    char *buffer;            // búfer propio (NULL si está mapeado)
+    size_t capacity;
+    int fd;                  // descriptor abierto mientras quede por leer en streaming; -1 si no
+} InputText;
+
+// Bytes que se piden al descriptor por lectura en streaming.
+#define INPUT_READ_CHUNK (1u << 16)
+
+// Lee el descriptor completo a memoria cuando no se puede mapear.
+static char *read_whole_fd(int fd, size_t *size) {
+    size_t capacity = 1 << 16;
+    size_t used = 0;
+    char *data = xmalloc(capacity);
+    for (;;) {
+        if (used == capacity) {
+            capacity *= 2;
+            data = xrealloc(data, capacity);
         }
+        ssize_t got = read(fd, data + used, capacity - used);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        used += (size_t)got;
+    }
+    *size = used;
+    return data;
+}
+
+// Abre path ("-" es la entrada estándar). Con streaming, lo que no se puede mapear se lee de a bloques
+// y la memoria queda acotada a la línea más larga; si no, se lee completo.
+static int input_open(InputText *input, const char *path, int streaming) {
+    memset(input, 0, sizeof(*input));
+    input->fd = -1;
+    int fd = strcmp(path, "-") == 0 ? dup(STDIN_FILENO) : open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    int regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    if (regular && st.st_size > 0) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+            input->data = map;
+            input->size = (size_t)st.st_size;
+            input->mapped = 1;
+        }
+    }
+    if (input->mapped || (regular && st.st_size == 0)) {
+        close(fd);
+    } else if (streaming) {
+        input->capacity = INPUT_READ_CHUNK;
+        input->buffer = xmalloc(input->capacity);
+        input->data = input->buffer;
+        input->fd = fd;
+    } else {
+        input->buffer = read_whole_fd(fd, &input->size);
+        input->data = input->buffer;
+        close(fd);
+    }
+    return 0;
+}
+
+// En streaming descarta los bytes anteriores a keep y lee otro bloque al final; devuelve 0 si ya no
+// queda nada por leer. El búfer solo crece si una línea no entra entera.
+static int input_refill(InputText *input, size_t keep) {
+    if (input->fd < 0) {
+        return 0;
+    }
+    size_t rest = input->size - keep;
+    memmove(input->buffer, input->buffer + keep, rest);
+    input->size = rest;
+    if (rest == input->capacity) {
+        input->capacity *= 2;
+        input->buffer = xrealloc(input->buffer, input->capacity);
+    }
+    input->data = input->buffer;
+    ssize_t got;
+    do {
+        got = read(input->fd, input->buffer + rest, input->capacity - rest);
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0) {
+        close(input->fd);
+        input->fd = -1;
+        return 0;
+    }
+    input->size += (size_t)got;
+    return 1;
+}
+
+static void input_close(InputText *input) {
+    if (input->mapped) {
+        munmap((void *)input->data, input->size);
+    } else {
+        free(input->buffer);
+    }
+    if (input->fd >= 0) {
+        close(input->fd);
+    }
+}
+
+// Devuelve el fin de la línea que empieza en line (sin el '\n') y deja en *next el inicio de la siguiente.
+// memchr está vectorizado en la libc.
+static const char *line_end(const char *line, const char *limit, const char **next) {
+    const char *newline = memchr(line, '\n', (size_t)(limit - line));
+    *next = newline ? newline + 1 : limit;
+    return newline ? newline : limit;
+}
+
+struct InstrReader {
+    InputText input;
+    size_t pos;              // inicio de la próxima línea
+    size_t line_no;
+    ParseState state;
+};
+
+InstrReader *instr_reader_open(const char *path) {
+    InstrReader *reader = xmalloc(sizeof(InstrReader));
+    memset(reader, 0, sizeof(*reader));
+    if (input_open(&reader->input, path, 1) != 0) {
+        free(reader);
         return NULL;
     }
+    return reader;
+}
+
+// Lee la siguiente instrucción válida; devuelve 1 si la hay, 0 al final del archivo y -1 ante un error.
+int instr_reader_next(InstrReader *reader, Instruction *out) {
+    InputText *input = &reader->input;
+    for (;;) {
+        const char *line = input->data + reader->pos;
+        const char *limit = input->data + input->size;
+        const char *newline = line < limit ? memchr(line, '\n', (size_t)(limit - line)) : NULL;
+        // En streaming una línea sin '\n' puede seguir en el próximo bloque
+        if (!newline && input->fd >= 0) {
+            input_refill(input, reader->pos);
+            reader->pos = 0;
+            continue;
+        }
+        if (line >= limit) {
+            return 0;
+        }
+        const char *end = newline ? newline : limit;
+        reader->pos = (size_t)(end - input->data) + (newline ? 1 : 0);
+        size_t line_no = ++reader->line_no;
+
+        ParsedLine parsed;
+        parse_line(line, end, &parsed);
+        if (parsed.kind == LINE_SKIP) {
+            continue;
+        }
+        if (parsed.kind != LINE_INSTR) {
+            report_syntax_error(&parsed, line_no);
+            return -1;
+        }
+        SemanticError error = apply_semantics(&reader->state, &parsed.instr);
+        if (error != SEM_OK) {
+            report_semantic_error(error, &parsed.instr, "line", line_no);
+            return -1;
+        }
+        *out = parsed.instr;
+        return 1;
+    }
+}
+
+void instr_reader_close(InstrReader *reader) {
+    if (!reader) {
+        return;
+    }
+    input_close(&reader->input);
+    parse_state_free(&reader->state);
+    free(reader);
+}
+
+// Carga todas las instrucciones del lector, una línea por vez, y lo cierra.
+static Instruction *read_all_instructions(InstrReader *reader, size_t *count) {
+    InstructionBuffer buffer = {0};
+    Instruction instr;
+    int status;
+    while ((status = instr_reader_next(reader, &instr)) > 0) {
+        ensure_instruction_capacity(&buffer, buffer.count + 1);
+        buffer.data[buffer.count++] = instr;
+    }
+    instr_reader_close(reader);
 
-    if (buffer.count == 0) {
+    if (status < 0 || buffer.count == 0) {
         free(buffer.data);
         return NULL;
     }
@@ -302,6 +704,195 @@ Instruction *parse_instructions_from_file(const char *path, size_t *count) {
     return buffer.data;
 }
 
+// Tramo de archivo alineado a líneas que un hilo analiza sintácticamente.
+typedef struct ParseChunk {
+    const char *begin;
+    const char *end;
+    InstructionBuffer items;
+    size_t lines;            // líneas recorridas, incluida la del error si lo hubo
+    ParsedLine error;        // kind LINE_SKIP si el tramo no tiene errores de sintaxis
+    Instruction *dest;       // lugar del tramo en el arreglo final
+} ParseChunk;
+
+// Analiza las líneas del tramo hasta el final o hasta el primer error de sintaxis.
+static void *parse_chunk_main(void *arg) {
+    ParseChunk *chunk = arg;
+    // Unos 12 bytes por línea en las trazas habituales: reserva de una vez en vez de crecer de a poco
+    ensure_instruction_capacity(&chunk->items, (size_t)(chunk->end - chunk->begin) / 12 + 16);
+    chunk->error.kind = LINE_SKIP;
+    const char *line = chunk->begin;
+    while (line < chunk->end) {
+        const char *next;
+        const char *end = line_end(line, chunk->end, &next);
+        chunk->lines++;
+        ParsedLine parsed;
+        parse_line(line, end, &parsed);
+        if (parsed.kind == LINE_INSTR) {
+            ensure_instruction_capacity(&chunk->items, chunk->items.count + 1);
+            chunk->items.data[chunk->items.count++] = parsed.instr;
+        } else if (parsed.kind != LINE_SKIP) {
+            chunk->error = parsed;
+            break;
+        }
+        line = next;
+    }
+    return NULL;
+}
+
+// Línea (relativa al tramo, desde 1) de la instrucción index del tramo; solo se usa al informar errores.
+static size_t chunk_line_of(const ParseChunk *chunk, size_t index) {
+    size_t line_no = 0;
+    size_t seen = 0;
+    const char *line = chunk->begin;
+    while (line < chunk->end) {
+        const char *next;
+        const char *end = line_end(line, chunk->end, &next);
+        ++line_no;
+        ParsedLine parsed;
+        parse_line(line, end, &parsed);
+        if (parsed.kind == LINE_INSTR && seen++ == index) {
+            break;
+        }
+        line = next;
+    }
+    return line_no;
+}
+
+// Corta el texto en chunk_count tramos de tamaño parecido que empiezan justo después de un '\n'.
+static void split_chunks(const char *data, size_t size, ParseChunk *chunks, size_t chunk_count) {
+    const char *previous = data;
+    for (size_t c = 0; c < chunk_count; ++c) {
+        const char *begin = previous;
+        if (c > 0) {
+            const char *target = data + size / chunk_count * c;
+            if (target > begin) {
+                const char *newline = memchr(target - 1, '\n', (size_t)(data + size - (target - 1)));
+                begin = newline ? newline + 1 : data + size;
+            }
+        }
+        chunks[c].begin = begin;
+        if (c > 0) {
+            chunks[c - 1].end = begin;
+        }
+        previous = begin;
+    }
+    chunks[chunk_count - 1].end = data + size;
+}
+
+// Paso secuencial: asigna ids y valida en orden de archivo sobre los búferes de cada tramo, sin copiar.
+// Informa el primer error igual que el lector; devuelve 0 o -1.
+static int validate_chunks(ParseChunk *chunks, size_t chunk_count) {
+    ParseState state;
+    memset(&state, 0, sizeof(state));
+    size_t base_line = 0;
+    int status = 0;
+    for (size_t c = 0; c < chunk_count && status == 0; ++c) {
+        ParseChunk *chunk = &chunks[c];
+        for (size_t k = 0; k < chunk->items.count; ++k) {
+            Instruction *instr = &chunk->items.data[k];
+            SemanticError error = apply_semantics(&state, instr);
+            if (error != SEM_OK) {
+                report_semantic_error(error, instr, "line", base_line + chunk_line_of(chunk, k));
+                status = -1;
+                break;
+            }
+        }
+        if (status == 0 && chunk->error.kind != LINE_SKIP) {
+            report_syntax_error(&chunk->error, base_line + chunk->lines);
+            status = -1;
+        }
+        base_line += chunk->lines;
+    }
+    parse_state_free(&state);
+    return status;
+}
+
+// Copia un tramo validado a su lugar en el arreglo final y libera su búfer.
+static void *gather_chunk_main(void *arg) {
+    ParseChunk *chunk = arg;
+    memcpy(chunk->dest, chunk->items.data, chunk->items.count * sizeof(Instruction));
+    free(chunk->items.data);
+    chunk->items.data = NULL;
+    return NULL;
+}
+
+// Corre fn sobre cada tramo en su propio hilo; el hilo llamador atiende el tramo 0.
+static void run_chunks(ParseChunk *chunks, size_t chunk_count, void *(*fn)(void *)) {
+    pthread_t *handles = xmalloc(chunk_count * sizeof(pthread_t));
+    for (size_t c = 1; c < chunk_count; ++c) {
+        if (pthread_create(&handles[c], NULL, fn, &chunks[c]) != 0) {
+            fprintf(stderr, "Cannot start parser thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    fn(&chunks[0]);
+    for (size_t c = 1; c < chunk_count; ++c) {
+        pthread_join(handles[c], NULL);
+    }
+    free(handles);
+}
+
+Instruction *parse_instructions_parallel(const char *path, size_t *count, size_t threads) {
+    if (count) {
+        *count = 0;
+    }
+    InputText input;
+    if (input_open(&input, path, 0) != 0) {
+        return NULL;
+    }
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    size_t chunk_count = input.size / PARSE_MIN_CHUNK;
+    if (chunk_count > threads) {
+        chunk_count = threads;
+    }
+    if (chunk_count <= 1) {
+        // El texto ya está en memoria (una tubería no se puede releer): el lector lo recorre tal cual
+        InstrReader *reader = xmalloc(sizeof(InstrReader));
+        memset(reader, 0, sizeof(*reader));
+        reader->input = input;
+        return read_all_instructions(reader, count);
+    }
+
+    ParseChunk *chunks = xmalloc(chunk_count * sizeof(ParseChunk));
+    memset(chunks, 0, chunk_count * sizeof(ParseChunk));
+    split_chunks(input.data, input.size, chunks, chunk_count);
+    run_chunks(chunks, chunk_count, parse_chunk_main);
+
+    Instruction *list = NULL;
+    size_t total = 0;
+    if (validate_chunks(chunks, chunk_count) == 0) {
+        for (size_t c = 0; c < chunk_count; ++c) {
+            total += chunks[c].items.count;
+        }
+    }
+    if (total > 0) {
+        // Cada hilo copia (y así toca por primera vez) su parte del arreglo final
+        list = xmalloc(total * sizeof(Instruction));
+        size_t offset = 0;
+        for (size_t c = 0; c < chunk_count; ++c) {
+            chunks[c].dest = list + offset;
+            offset += chunks[c].items.count;
+        }
+        run_chunks(chunks, chunk_count, gather_chunk_main);
+    }
+    for (size_t c = 0; c < chunk_count; ++c) {
+        free(chunks[c].items.data);
+    }
+    free(chunks);
+    input_close(&input);
+    if (list && count) {
+        *count = total;
+    }
+    return list;
+}
+
+Instruction *parse_instructions_from_file(const char *path, size_t *count) {
+    return parse_instructions_parallel(path, count, 0);
+}
+
 // Genera instrucciones pseudoaleatorias conforme a los parámetros recibidos.
 Instruction *generate_instructions(int P, int N, unsigned int seed, size_t *count) {
     if (count) {
@@ -0,0 +1,698 @@
+#include "mrc.h"
+#include "id_map.h"
+#include "util.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MRC_MIN_SLOTS 1024
+#define MRC_MIN_FRAMES 64
+
+// Árbol de segmentos sobre los instantes de acceso con suma por rango y máximo histórico por posición.
+// La posición s guarda cuántas páginas vivas se usaron después del instante s; su máximo histórico es
+// la mayor cantidad de páginas que llegaron a estar por encima de la página cuyo último acceso fue s.
+typedef struct {
+    int32_t cur;             // máximo actual del nodo
+    int32_t hist;            // máximo histórico del nodo
+    int32_t add;             // suma pendiente para los hijos
+    int32_t hadd;            // mayor prefijo de las sumas pendientes
+} HistoryNode;
+
+typedef struct {
+    HistoryNode *nodes;      // nodo 1 es la raíz sobre [1, size]
+    size_t size;
+} HistoryTree;
+
+static int32_t max_i32(int32_t a, int32_t b) {
+    return a > b ? a : b;
+}
+
+static void history_init(HistoryTree *tree, size_t size) {
+    tree->size = size ? size : 1;
+    tree->nodes = xmalloc(4 * tree->size * sizeof(HistoryNode));
+    memset(tree->nodes, 0, 4 * tree->size * sizeof(HistoryNode));
+}
+
+// Aplica al nodo una secuencia de sumas con total add y mayor prefijo hadd.
+static void history_apply(HistoryNode *node, int32_t add, int32_t hadd) {
+    node->hist = max_i32(node->hist, node->cur + hadd);
+    node->hadd = max_i32(node->hadd, node->add + hadd);
+    node->cur += add;
+    node->add += add;
+}
+
+static void history_push(HistoryTree *tree, size_t node) {
+    HistoryNode *n = &tree->nodes[node];
+    if (n->add == 0 && n->hadd == 0) {
+        return;
+    }
+    history_apply(&tree->nodes[2 * node], n->add, n->hadd);
+    history_apply(&tree->nodes[2 * node + 1], n->add, n->hadd);
+    n->add = 0;
+    n->hadd = 0;
+}
+
+static void history_add_rec(HistoryTree *tree, size_t node, size_t lo, size_t hi, size_t l, size_t r, int32_t delta) {
+    if (r < lo || hi < l) {
+        return;
+    }
+    if (l <= lo && hi <= r) {
+        history_apply(&tree->nodes[node], delta, delta);
+        return;
+    }
+    history_push(tree, node);
+    size_t mid = lo + (hi - lo) / 2;
+    history_add_rec(tree, 2 * node, lo, mid, l, r, delta);
+    history_add_rec(tree, 2 * node + 1, mid + 1, hi, l, r, delta);
+    HistoryNode *n = &tree->nodes[node];
+    n->cur = max_i32(tree->nodes[2 * node].cur, tree->nodes[2 * node + 1].cur);
+    n->hist = max_i32(tree->nodes[2 * node].hist, tree->nodes[2 * node + 1].hist);
+}
+
+// Suma delta a las posiciones [l, r].
+static void history_add(HistoryTree *tree, size_t l, size_t r, int32_t delta) {
+    if (l > r) {
+        return;
+    }
+    history_add_rec(tree, 1, 1, tree->size, l, r, delta);
+}
+
+// Devuelve el nodo hoja de la posición pos con las sumas pendientes ya aplicadas.
+static HistoryNode *history_leaf(HistoryTree *tree, size_t pos) {
+    size_t node = 1;
+    size_t lo = 1;
+    size_t hi = tree->size;
+    while (lo < hi) {
+        history_push(tree, node);
+        size_t mid = lo + (hi - lo) / 2;
+        if (pos <= mid) {
+            node = 2 * node;
+            hi = mid;
+        } else {
+            node = 2 * node + 1;
+            lo = mid + 1;
+        }
+    }
+    return &tree->nodes[node];
+}
+
+// Arma el árbol de abajo hacia arriba a partir de hojas ya cargadas en leaves[0..count).
+static void history_build_rec(HistoryTree *tree, size_t node, size_t lo, size_t hi, const HistoryNode *leaves,
+                              size_t count) {
+    HistoryNode *n = &tree->nodes[node];
+    n->add = 0;
+    n->hadd = 0;
+    if (lo == hi) {
+        n->cur = lo <= count ? leaves[lo - 1].cur : 0;
+        n->hist = lo <= count ? leaves[lo - 1].hist : 0;
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    history_build_rec(tree, 2 * node, lo, mid, leaves, count);
+    history_build_rec(tree, 2 * node + 1, mid + 1, hi, leaves, count);
+    n->cur = max_i32(tree->nodes[2 * node].cur, tree->nodes[2 * node + 1].cur);
+    n->hist = max_i32(tree->nodes[2 * node].hist, tree->nodes[2 * node + 1].hist);
+}
+
+// Árbol de Fenwick sobre las diferencias de una función no decreciente en [1, size]: suma por rango,
+// consulta puntual y búsqueda del último punto donde vale cero.
+typedef struct {
+    int64_t *tree;
+    size_t size;
+} Fenwick;
+
+// Arma el árbol en O(size) a partir de las diferencias diff[1..size].
+static void fenwick_build(Fenwick *fw, const int64_t *diff, size_t size) {
+    fw->size = size;
+    fw->tree = xmalloc((size + 1) * sizeof(int64_t));
+    memcpy(fw->tree, diff, (size + 1) * sizeof(int64_t));
+    fw->tree[0] = 0;
+    for (size_t i = 1; i <= size; ++i) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= size) {
+            fw->tree[parent] += fw->tree[i];
+        }
+    }
+}
+
+static void fenwick_point_add(Fenwick *fw, size_t pos, int64_t delta) {
+    for (; pos <= fw->size; pos += pos & (~pos + 1)) {
+        fw->tree[pos] += delta;
+    }
+}
+
+// Valor en pos: suma de las diferencias en [1, pos].
+static int64_t fenwick_value(const Fenwick *fw, size_t pos) {
+    int64_t sum = 0;
+    for (; pos > 0; pos &= pos - 1) {
+        sum += fw->tree[pos];
+    }
+    return sum;
+}
+
+// Suma delta a los valores en [l, r].
+static void fenwick_range_add(Fenwick *fw, size_t l, size_t r, int64_t delta) {
+    if (l > r || l > fw->size) {
+        return;
+    }
+    fenwick_point_add(fw, l, delta);
+    if (r < fw->size) {
+        fenwick_point_add(fw, r + 1, -delta);
+    }
+}
+
+// Último f con valor cero (0 si ninguno); requiere que las diferencias sean no negativas.
+static size_t fenwick_last_zero(const Fenwick *fw) {
+    size_t pos = 0;
+    size_t step = 1;
+    while (step * 2 <= fw->size) {
+        step *= 2;
+    }
+    int64_t sum = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= fw->size && sum + fw->tree[pos + step] <= 0) {
+            pos += step;
+            sum += fw->tree[pos];
+        }
+    }
+    return pos;
+}
+
+// Reserva un histograma de count contadores en cero.
+static int64_t *histogram_alloc(size_t count) {
+    int64_t *hist = xmalloc(count * sizeof(int64_t));
+    memset(hist, 0, count * sizeof(int64_t));
+    return hist;
+}
+
+// Estado de la pasada de distancias de pila de LRU sobre una secuencia de accesos y liberaciones.
+// Como delete()/kill() dejan marcos libres que se ocupan sin expulsar, la distancia de una página no es
+// la de la pila clásica sino el máximo de páginas vivas usadas después de su último acceso mientras
+// estuvo sin usarse, más uno: con f marcos la página sigue en RAM sii esa distancia es <= f.
+// Los marcos libres por tamaño (free[f]) son no decrecientes en f, así que new() falla exactamente en
+// los tamaños [1, K] con K el último f sin marcos libres.
+typedef struct {
+    IdMap last_access;       // página viva -> instante de su último acceso
+    HistoryTree history;     // un instante por acceso, compactado al llenarse
+    size_t next_slot;
+    Fenwick free_frames;     // free[f] para f en [1, frame_limit]; más allá vale f - live
+    int64_t *fault_diff;     // diferencias de las fallas por tamaño, [1, frame_limit + 1]
+    size_t frame_limit;      // siempre mayor que el pico de páginas vivas
+    size_t live;
+    size_t peak;
+    size_t accesses;
+} LruStack;
+
+static void lru_stack_init(LruStack *stack) {
+    memset(stack, 0, sizeof(*stack));
+    id_map_init(&stack->last_access);
+    history_init(&stack->history, MRC_MIN_SLOTS);
+    stack->next_slot = 1;
+    stack->frame_limit = MRC_MIN_FRAMES;
+    int64_t *diff = histogram_alloc(stack->frame_limit + 1);
+    for (size_t f = 1; f <= stack->frame_limit; ++f) {
+        diff[f] = 1;                                     // free[f] = f al inicio
+    }
+    fenwick_build(&stack->free_frames, diff, stack->frame_limit);
+    free(diff);
+    stack->fault_diff = histogram_alloc(stack->frame_limit + 2);
+}
+
+static void lru_stack_free(LruStack *stack) {
+    id_map_free(&stack->last_access);
+    free(stack->history.nodes);
+    free(stack->free_frames.tree);
+    free(stack->fault_diff);
+    memset(stack, 0, sizeof(*stack));
+}
+
+// Duplica el rango de tamaños seguido; por encima del pico nunca hubo expulsiones y free[f] = f - live.
+static void lru_stack_grow_frames(LruStack *stack) {
+    size_t old_limit = stack->frame_limit;
+    size_t new_limit = old_limit * 2;
+    int64_t *diff = histogram_alloc(new_limit + 1);
+    int64_t previous = 0;
+    for (size_t f = 1; f <= new_limit; ++f) {
+        int64_t value = f <= old_limit ? fenwick_value(&stack->free_frames, f) : (int64_t)(f - stack->live);
+        diff[f] = value - previous;
+        previous = value;
+    }
+    free(stack->free_frames.tree);
+    fenwick_build(&stack->free_frames, diff, new_limit);
+    free(diff);
+
+    stack->fault_diff = realloc(stack->fault_diff, (new_limit + 2) * sizeof(int64_t));
+    if (!stack->fault_diff) {
+        fprintf(stderr, "Out of memory (mrc realloc)\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(stack->fault_diff + old_limit + 2, 0, (new_limit - old_limit) * sizeof(int64_t));
+    stack->frame_limit = new_limit;
+}
+
+typedef struct {
+    uint32_t slot;
+    uint32_t page;
+} SlotEntry;
+
+static int compare_slots(const void *a, const void *b) {
+    uint32_t x = ((const SlotEntry *)a)->slot;
+    uint32_t y = ((const SlotEntry *)b)->slot;
+    return (x > y) - (x < y);
+}
+
+// Renumera los instantes de las páginas vivas como 1..live conservando su orden y sus contadores,
+// y reserva espacio para al menos otros tantos accesos. Así la memoria sigue a las páginas vivas.
+static void lru_stack_compact(LruStack *stack) {
+    IdMap *map = &stack->last_access;
+    SlotEntry *entries = xmalloc((map->count ? map->count : 1) * sizeof(SlotEntry));
+    size_t count = 0;
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->keys[i]) {
+            entries[count].slot = (uint32_t)map->values[i];
+            entries[count].page = map->keys[i];
+            count++;
+        }
+    }
+    qsort(entries, count, sizeof(SlotEntry), compare_slots);
+
+    HistoryNode *leaves = xmalloc((count ? count : 1) * sizeof(HistoryNode));
+    for (size_t k = 0; k < count; ++k) {
+        leaves[k] = *history_leaf(&stack->history, entries[k].slot);
+        id_map_put(map, entries[k].page, k + 1);
+    }
+
+    size_t size = 4 * count > MRC_MIN_SLOTS ? 4 * count : MRC_MIN_SLOTS;
+    free(stack->history.nodes);
+    history_init(&stack->history, size);
+    history_build_rec(&stack->history, 1, 1, size, leaves, count);
+    stack->next_slot = count + 1;
+
+    free(leaves);
+    free(entries);
+}
+
+// Procesa un acceso (NEW si la página no está viva, USE si lo está).
+static void lru_stack_access(LruStack *stack, sim_pageid_t page_id) {
+    if (stack->next_slot > stack->history.size) {
+        lru_stack_compact(stack);
+    }
+    if (stack->live + 1 >= stack->frame_limit) {
+        lru_stack_grow_frames(stack);
+    }
+
+    size_t now = stack->next_slot++;
+    size_t full = fenwick_last_zero(&stack->free_frames);
+    uint64_t *previous = id_map_find(&stack->last_access, page_id);
+    if (previous) {
+        // Falla en los tamaños menores que la distancia; los que tenían marcos libres gastan uno
+        size_t slot = (size_t)*previous;
+        size_t distance = (size_t)history_leaf(&stack->history, slot)->hist + 1;
+        stack->fault_diff[1]++;
+        stack->fault_diff[distance]--;
+        fenwick_range_add(&stack->free_frames, full + 1, distance - 1, -1);
+        history_add(&stack->history, slot, now - 1, 1);
+        *previous = now;
+    } else {
+        // Página nueva: acierto si hay un marco libre, si no, falla
+        stack->fault_diff[1]++;
+        stack->fault_diff[full + 1]--;
+        fenwick_range_add(&stack->free_frames, full + 1, stack->frame_limit, -1);
+        history_add(&stack->history, 1, now - 1, 1);
+        id_map_put(&stack->last_access, page_id, now);
+        if (++stack->live > stack->peak) {
+            stack->peak = stack->live;
+        }
+    }
+    stack->accesses++;
+}
+
+// La página liberada devuelve su marco en los tamaños donde seguía en RAM y sale de la pila.
+static void lru_stack_release(LruStack *stack, sim_pageid_t page_id) {
+    uint64_t *previous = id_map_find(&stack->last_access, page_id);
+    if (!previous) {
+        return;
+    }
+    size_t slot = (size_t)*previous;
+    size_t distance = (size_t)history_leaf(&stack->history, slot)->hist + 1;
+    fenwick_range_add(&stack->free_frames, distance, stack->frame_limit, 1);
+    history_add(&stack->history, 1, slot - 1, -1);
+    id_map_remove(&stack->last_access, page_id);
+    stack->live--;
+}
+
+// Vuelca en la curva las fallas por tamaño acumulando diff[1..peak], multiplicadas por scale.
+static void curve_from_diff(const int64_t *diff, size_t peak, double scale, MissRatioCurve *curve) {
+    curve->points = peak ? peak : 1;
+    curve->faults = xmalloc((curve->points + 1) * sizeof(size_t));
+    curve->faults[0] = curve->access_count;
+    int64_t running = 0;
+    for (size_t f = 1; f <= curve->points; ++f) {
+        running += diff[f];
+        curve->faults[f] = (size_t)llround((double)running * scale);
+    }
+}
+
+static void lru_stack_curve(const LruStack *stack, double scale, MissRatioCurve *curve) {
+    curve_from_diff(stack->fault_diff, stack->peak, scale, curve);
+}
+
+void mrc_build_lru(const SimManager *mgr, MissRatioCurve *curve) {
+    if (!curve) {
+        return;
+    }
+    memset(curve, 0, sizeof(*curve));
+    if (!mgr || !mgr->instr_event_offsets) {
+        return;
+    }
+
+    LruStack stack;
+    lru_stack_init(&stack);
+    size_t release = 0;
+    for (size_t i = 0; i < mgr->instr_count; ++i) {
+        for (size_t e = mgr->instr_event_offsets[i]; e < mgr->instr_event_offsets[i + 1]; ++e) {
+            lru_stack_access(&stack, mgr->events[e]);
+        }
+        // Las páginas liberadas en esta instrucción salen de la pila
+        for (; release < mgr->release_count && mgr->releases[release].instruction_index == i; ++release) {
+            const PageRelease *range = &mgr->releases[release];
+            for (uint32_t p = 0; p < range->num_pages; ++p) {
+                lru_stack_release(&stack, range->first_page + p);
+            }
+        }
+    }
+
+    curve->frame_step = 1.0;
+    curve->access_count = mgr->event_count;
+    lru_stack_curve(&stack, 1.0, curve);
+    lru_stack_free(&stack);
+}
+
+#define OPT_FREE_KEY UINT64_MAX
+
+// Pila de prioridades de Mattson para OPT: con f marcos la RAM contiene las páginas de las posiciones
+// [1, f]. La clave de una página es su próximo uso; sin usos futuros, 2^32 más la instrucción que la
+// libera, así entre páginas muertas se expulsa primero la que se libera más tarde (o nunca). Un marco
+// liberado queda como hueco con la clave máxima, que se consume antes de expulsar a nadie.
+// Al acceder, la página sube a la cima y la que baja en cada posición es la de mayor clave entre la
+// que viene bajando y la que estaba; como solo cambian las posiciones donde la clave supera a la que
+// baja, esos récords se buscan con un árbol de máximos y el resto de la pila no se toca.
+typedef struct {
+    uint64_t *keys;          // árbol de máximos por posición; la hoja de la posición p es leaves + p
+    size_t leaves;
+    sim_pageid_t *pages;     // página en cada posición, 0 para un hueco
+    uint32_t *position;      // posición de cada página en la pila, 0 si no está
+    size_t *cursor;          // próximo uso pendiente de cada página en el índice de usos futuros
+    int64_t *fault_diff;     // diferencias de las fallas por tamaño, [1, leaves]
+    size_t *touched;         // hojas escritas durante el acceso en curso
+    size_t touched_count;
+    size_t page_capacity;
+    size_t len;              // posiciones ocupadas; los huecos del fondo se descartan
+    size_t peak;
+} OptStack;
+
+static void opt_stack_init(OptStack *stack, const FutureUseIndex *index) {
+    memset(stack, 0, sizeof(*stack));
+    stack->page_capacity = index->page_capacity;
+    // Cada página ocupa a lo sumo una posición, así que la pila nunca supera la cantidad de ids
+    stack->leaves = 2;
+    while (stack->leaves <= index->page_capacity) {
+        stack->leaves *= 2;
+    }
+    stack->keys = xmalloc(2 * stack->leaves * sizeof(uint64_t));
+    memset(stack->keys, 0, 2 * stack->leaves * sizeof(uint64_t));
+    stack->pages = xmalloc(stack->leaves * sizeof(sim_pageid_t));
+    memset(stack->pages, 0, stack->leaves * sizeof(sim_pageid_t));
+    stack->position = xmalloc(index->page_capacity * sizeof(uint32_t));
+    memset(stack->position, 0, index->page_capacity * sizeof(uint32_t));
+    stack->cursor = xmalloc(index->page_capacity * sizeof(size_t));
+    memcpy(stack->cursor, index->offsets, index->page_capacity * sizeof(size_t));
+    stack->fault_diff = histogram_alloc(stack->leaves + 1);
+    stack->touched = xmalloc(stack->leaves * sizeof(size_t));
+}
+
+static void opt_stack_free(OptStack *stack) {
+    free(stack->keys);
+    free(stack->pages);
+    free(stack->position);
+    free(stack->cursor);
+    free(stack->fault_diff);
+    free(stack->touched);
+    memset(stack, 0, sizeof(*stack));
+}
+
+// Ubica la página (o un hueco si page es 0) en pos con su clave y actualiza los máximos.
+static void opt_stack_set(OptStack *stack, size_t pos, sim_pageid_t page_id, uint64_t key) {
+    stack->pages[pos] = page_id;
+    if (page_id) {
+        stack->position[page_id] = (uint32_t)pos;
+    }
+    size_t node = stack->leaves + pos;
+    stack->keys[node] = key;
+    for (node /= 2; node > 0; node /= 2) {
+        uint64_t left = stack->keys[2 * node];
+        uint64_t right = stack->keys[2 * node + 1];
+        stack->keys[node] = left > right ? left : right;
+    }
+}
+
+static uint64_t opt_stack_key(const OptStack *stack, size_t pos) {
+    return stack->keys[stack->leaves + pos];
+}
+
+// Escribe la hoja de pos sin recalcular los máximos; opt_stack_refresh los corrige después.
+static void opt_stack_place(OptStack *stack, size_t pos, sim_pageid_t page_id, uint64_t key) {
+    stack->pages[pos] = page_id;
+    if (page_id) {
+        stack->position[page_id] = (uint32_t)pos;
+    }
+    stack->keys[stack->leaves + pos] = key;
+    stack->touched[stack->touched_count++] = stack->leaves + pos;
+}
+
+// Recalcula los ancestros de las hojas escritas nivel por nivel; como se escribieron en orden
+// creciente, los ancestros compartidos quedan contiguos y se recalculan una sola vez.
+static void opt_stack_refresh(OptStack *stack) {
+    size_t *nodes = stack->touched;
+    size_t count = stack->touched_count;
+    while (count > 0 && nodes[0] > 1) {
+        size_t out = 0;
+        for (size_t i = 0; i < count; ++i) {
+            size_t parent = nodes[i] / 2;
+            if (out > 0 && nodes[out - 1] == parent) {
+                continue;
+            }
+            uint64_t left = stack->keys[2 * parent];
+            uint64_t right = stack->keys[2 * parent + 1];
+            stack->keys[parent] = left > right ? left : right;
+            nodes[out++] = parent;
+        }
+        count = out;
+    }
+    stack->touched_count = 0;
+}
+
+// Primera posición en (after, to) cuya clave supera a key, o 0 si no hay. Sube desde la hoja de
+// after mirando solo hermanos derechos, así el costo depende de la distancia al resultado y los
+// máximos desactualizados de posiciones <= after (ver opt_stack_place) nunca se consultan.
+static size_t opt_stack_find_after(const OptStack *stack, size_t after, size_t to, uint64_t key) {
+    size_t node = stack->leaves + after;
+    for (;;) {
+        if (node == 1) {
+            return 0;
+        }
+        if (!(node & 1) && stack->keys[node + 1] > key) {
+            node++;
+            break;
+        }
+        node /= 2;
+    }
+    while (node < stack->leaves) {
+        node = stack->keys[2 * node] > key ? 2 * node : 2 * node + 1;
+    }
+    size_t pos = node - stack->leaves;
+    return pos < to ? pos : 0;
+}
+
+// Descarta los huecos del fondo: equivalen a una pila más corta.
+static void opt_stack_trim(OptStack *stack) {
+    while (stack->len > 0 && stack->pages[stack->len] == 0) {
+        opt_stack_set(stack, stack->len, 0, 0);
+        stack->len--;
+    }
+}
+
+// Procesa el acceso del evento event a la página y acumula en qué tamaños fue falla.
+static void opt_stack_access(OptStack *stack, const FutureUseIndex *index, sim_pageid_t page_id, size_t event) {
+    if (page_id >= index->page_capacity) {
+        return;
+    }
+    size_t *cursor = &stack->cursor[page_id];
+    while (*cursor < index->offsets[page_id + 1] && index->positions[*cursor] <= event) {
+        (*cursor)++;
+    }
+    uint64_t key = *cursor < index->offsets[page_id + 1] ? index->positions[*cursor]
+                                                         : ((uint64_t)1 << 32) + index->release_at[page_id];
+
+    // USE: falla con menos marcos que su profundidad. new(): falla mientras no haya un hueco por
+    // encima ni lugar al fondo de la pila, y el hueco que consume termina bajando hasta descartarse.
+    size_t depth = stack->position[page_id];
+    size_t end = depth;
+    if (!depth) {
+        size_t hole = opt_stack_find_after(stack, 0, stack->len + 1, OPT_FREE_KEY - 1);
+        end = stack->len + 1;
+        depth = hole ? hole : end;
+    }
+    stack->fault_diff[1]++;
+    stack->fault_diff[depth]--;
+
+    sim_pageid_t carried = stack->pages[1];
+    uint64_t carried_key = opt_stack_key(stack, 1);
+    opt_stack_place(stack, 1, page_id, key);
+    if (end == 1) {
+        stack->len = stack->len ? stack->len : 1;
+    } else {
+        for (size_t at = 1;;) {
+            size_t next = opt_stack_find_after(stack, at, end, carried_key);
+            if (!next) {
+                break;
+            }
+            sim_pageid_t displaced = stack->pages[next];
+            uint64_t displaced_key = opt_stack_key(stack, next);
+            opt_stack_place(stack, next, carried, carried_key);
+            carried = displaced;
+            carried_key = displaced_key;
+            at = next;
+        }
+        if (end > stack->len) {
+            stack->len = end;
+        }
+        opt_stack_place(stack, end, carried, carried_key);
+    }
+    opt_stack_refresh(stack);
+    opt_stack_trim(stack);
+    if (stack->len > stack->peak) {
+        stack->peak = stack->len;
+    }
+}
+
+// La página liberada deja un hueco en su posición: un marco libre en los tamaños que la contenían.
+static void opt_stack_release(OptStack *stack, sim_pageid_t page_id) {
+    size_t pos = page_id < stack->page_capacity ? stack->position[page_id] : 0;
+    if (!pos) {
+        return;
+    }
+    stack->position[page_id] = 0;
+    opt_stack_set(stack, pos, 0, OPT_FREE_KEY);
+    opt_stack_trim(stack);
+}
+
+void mrc_build_opt(const SimManager *mgr, MissRatioCurve *curve) {
+    if (!curve) {
+        return;
+    }
+    memset(curve, 0, sizeof(*curve));
+    if (!mgr || !mgr->instr_event_offsets || !mgr->future_index.offsets) {
+        return;
+    }
+
+    const FutureUseIndex *index = &mgr->future_index;
+    OptStack stack;
+    opt_stack_init(&stack, index);
+    size_t release = 0;
+    for (size_t i = 0; i < mgr->instr_count; ++i) {
+        for (size_t e = mgr->instr_event_offsets[i]; e < mgr->instr_event_offsets[i + 1]; ++e) {
+            opt_stack_access(&stack, index, mgr->events[e], e);
+        }
+        for (; release < mgr->release_count && mgr->releases[release].instruction_index == i; ++release) {
+            const PageRelease *range = &mgr->releases[release];
+            for (uint32_t p = 0; p < range->num_pages; ++p) {
+                opt_stack_release(&stack, range->first_page + p);
+            }
+        }
+    }
+
+    curve->frame_step = 1.0;
+    curve->access_count = mgr->event_count;
+    curve_from_diff(stack.fault_diff, stack.peak, 1.0, curve);
+    opt_stack_free(&stack);
+}
+
+struct ShardsSampler {
+    LruStack stack;          // solo páginas muestreadas
+    uint64_t threshold;      // se muestrean los ids con mix_u64(id) <= threshold
+    double rate;
+    size_t accesses;         // eventos vistos, muestreados o no
+};
+
+ShardsSampler *shards_create(double rate) {
+    if (!(rate > 0.0)) {
+        return NULL;
+    }
+    ShardsSampler *sampler = xmalloc(sizeof(ShardsSampler));
+    memset(sampler, 0, sizeof(*sampler));
+    sampler->rate = rate < 1.0 ? rate : 1.0;
+    sampler->threshold = rate < 1.0 ? (uint64_t)(rate * 18446744073709551616.0) : UINT64_MAX;
+    lru_stack_init(&sampler->stack);
+    return sampler;
+}
+
+// La decisión depende solo del id, así que una página muestreada lo está en todos sus eventos.
+static int shards_sampled(const ShardsSampler *sampler, sim_pageid_t page_id) {
+    return mix_u64(page_id) <= sampler->threshold;
+}
+
+void shards_access(ShardsSampler *sampler, sim_pageid_t page_id) {
+    sampler->accesses++;
+    if (shards_sampled(sampler, page_id)) {
+        lru_stack_access(&sampler->stack, page_id);
+    }
+}
+
+void shards_release(ShardsSampler *sampler, sim_pageid_t page_id) {
+    if (shards_sampled(sampler, page_id)) {
+        lru_stack_release(&sampler->stack, page_id);
+    }
+}
+
+// La traza muestreada con f * rate marcos se comporta como la completa con f marcos; las fallas se
+// escalan por eventos totales / muestreados en lugar de 1/rate para corregir el error de muestreo.
+void shards_finish(const ShardsSampler *sampler, MissRatioCurve *curve) {
+    if (!curve) {
+        return;
+    }
+    memset(curve, 0, sizeof(*curve));
+    if (!sampler || sampler->stack.accesses == 0) {
+        return;
+    }
+    curve->frame_step = 1.0 / sampler->rate;
+    curve->access_count = sampler->accesses;
+    lru_stack_curve(&sampler->stack, (double)sampler->accesses / (double)sampler->stack.accesses, curve);
+}
+
+void shards_destroy(ShardsSampler *sampler) {
+    if (!sampler) {
+        return;
+    }
+    lru_stack_free(&sampler->stack);
+    free(sampler);
+}
+
+size_t mrc_faults(const MissRatioCurve *curve, size_t frames) {
+    if (!curve || !curve->faults) {
+        return 0;
+    }
+    size_t point = (size_t)llround((double)frames / curve->frame_step);
+    if (point > curve->points) {
+        point = curve->points;
+    }
+    return curve->faults[point];
+}
+
+void mrc_free(MissRatioCurve *curve) {
+    if (!curve) {
+        return;
+    }
+    free(curve->faults);
+    memset(curve, 0, sizeof(*curve));
+}
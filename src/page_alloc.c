@@ -0,0 +1,228 @@
+#include "page_alloc.h"
+#include "util.h"
+
+#include <string.h>
+
+// Variante de realloc que aborta si la reserva falla.
+static void *page_alloc_realloc(void *ptr, size_t size) {
+    void *tmp = realloc(ptr, size);
+    if (!tmp && size != 0) {
+        fprintf(stderr, "Out of memory (page_alloc realloc)\n");
+        exit(EXIT_FAILURE);
+    }
+    return tmp;
+}
+
+// Tramo más largo de bits en cero (ids libres) de una palabra.
+static uint64_t word_best_run(uint64_t used) {
+    uint64_t best = 0;
+    unsigned pos = 0;
+    while (pos < 64) {
+        uint64_t rest = used >> pos;
+        if (!rest) {
+            return best > 64 - pos ? best : 64 - pos;
+        }
+        unsigned run = (unsigned)__builtin_ctzll(rest);
+        if (run > best) {
+            best = run;
+        }
+        rest >>= run;
+        pos += run + (~rest ? (unsigned)__builtin_ctzll(~rest) : 64 - pos - run);
+    }
+    return best;
+}
+
+// Recalcula la hoja de la palabra w.
+static void leaf_update(PageIdAllocator *ids, size_t w) {
+    uint64_t used = ids->used[w];
+    size_t node = ids->words + w;
+    ids->run_pre[node] = used ? (uint64_t)__builtin_ctzll(used) : 64;
+    ids->run_suf[node] = used ? (uint64_t)__builtin_clzll(used) : 64;
+    ids->run_best[node] = word_best_run(used);
+}
+
+// Combina los hijos del nodo; half es la cantidad de ids que cubre cada hijo.
+static void node_pull(PageIdAllocator *ids, size_t node, uint64_t half) {
+    size_t l = 2 * node;
+    size_t r = l + 1;
+    ids->run_pre[node] = ids->run_pre[l] == half ? half + ids->run_pre[r] : ids->run_pre[l];
+    ids->run_suf[node] = ids->run_suf[r] == half ? half + ids->run_suf[l] : ids->run_suf[r];
+    uint64_t best = ids->run_suf[l] + ids->run_pre[r];
+    if (ids->run_best[l] > best) {
+        best = ids->run_best[l];
+    }
+    if (ids->run_best[r] > best) {
+        best = ids->run_best[r];
+    }
+    ids->run_best[node] = best;
+}
+
+// Rehace las hojas de las palabras [lo, hi] y sus ancestros.
+static void tree_update(PageIdAllocator *ids, size_t lo, size_t hi) {
+    for (size_t w = lo; w <= hi; ++w) {
+        leaf_update(ids, w);
+    }
+    size_t a = (ids->words + lo) / 2;
+    size_t b = (ids->words + hi) / 2;
+    for (uint64_t half = 64; a >= 1; a /= 2, b /= 2, half *= 2) {
+        for (size_t node = a; node <= b; ++node) {
+            node_pull(ids, node, half);
+        }
+    }
+}
+
+// Amplía el mapa de bits hasta cubrir needed ids; los nuevos quedan libres.
+static void tree_grow(PageIdAllocator *ids, uint64_t needed) {
+    size_t words = ids->words ? ids->words : 1;
+    while ((uint64_t)words * 64 < needed) {
+        words *= 2;
+    }
+    if (words == ids->words) {
+        return;
+    }
+    ids->used = page_alloc_realloc(ids->used, words * sizeof(uint64_t));
+    memset(ids->used + ids->words, 0, (words - ids->words) * sizeof(uint64_t));
+    ids->used[0] |= 1;  // el id 0 no se asigna nunca
+    ids->run_pre = page_alloc_realloc(ids->run_pre, 2 * words * sizeof(uint64_t));
+    ids->run_suf = page_alloc_realloc(ids->run_suf, 2 * words * sizeof(uint64_t));
+    ids->run_best = page_alloc_realloc(ids->run_best, 2 * words * sizeof(uint64_t));
+    ids->words = words;
+    tree_update(ids, 0, words - 1);
+}
+
+// Marca [first, first + count) como ocupados (used = 1) o libres.
+static void bits_assign(PageIdAllocator *ids, uint64_t first, uint64_t count, int used) {
+    size_t lo = (size_t)(first / 64);
+    size_t hi = (size_t)((first + count - 1) / 64);
+    for (size_t w = lo; w <= hi; ++w) {
+        uint64_t begin = w == lo ? first % 64 : 0;
+        uint64_t end = w == hi ? (first + count - 1) % 64 + 1 : 64;
+        uint64_t mask = (end - begin == 64 ? ~(uint64_t)0 : (((uint64_t)1 << (end - begin)) - 1)) << begin;
+        ids->used[w] = used ? ids->used[w] | mask : ids->used[w] & ~mask;
+    }
+    tree_update(ids, lo, hi);
+}
+
+// Primer id del tramo libre más a la izquierda con al menos count ids; los ids por encima del mapa
+// cuentan como libres, así que siempre hay respuesta.
+static uint64_t tree_find(const PageIdAllocator *ids, uint64_t count) {
+    uint64_t total = (uint64_t)ids->words * 64;
+    if (ids->run_best[1] < count) {
+        return total - ids->run_suf[1];
+    }
+    size_t node = 1;
+    uint64_t base = 0;
+    uint64_t half = total / 2;
+    while (node < ids->words) {
+        size_t l = 2 * node;
+        if (ids->run_best[l] >= count) {
+            node = l;
+        } else if (ids->run_suf[l] + ids->run_pre[l + 1] >= count) {
+            return base + half - ids->run_suf[l];
+        } else {
+            node = l + 1;
+            base += half;
+        }
+        half /= 2;
+    }
+
+    // Dentro de la hoja: el primer tramo de bits en cero que alcanza
+    uint64_t used = ids->used[node - ids->words];
+    unsigned pos = 0;
+    while (pos < 64) {
+        uint64_t rest = used >> pos;
+        unsigned run = rest ? (unsigned)__builtin_ctzll(rest) : 64 - pos;
+        if (run >= count) {
+            break;
+        }
+        rest >>= run;
+        pos += run + (~rest ? (unsigned)__builtin_ctzll(~rest) : 64 - pos - run);
+    }
+    return base + pos;
+}
+
+// Pasa a libres los rangos pendientes que ya cumplieron la distancia de reutilización.
+static void pending_collect(PageIdAllocator *ids) {
+    while (ids->pending_head < ids->pending_count && ids->pending[ids->pending_head].ready_at <= ids->allocated) {
+        const PageIdRange *range = &ids->pending[ids->pending_head++];
+        bits_assign(ids, range->first_page, range->num_pages, 0);
+    }
+    if (ids->pending_head == ids->pending_count) {
+        ids->pending_head = 0;
+        ids->pending_count = 0;
+    }
+}
+
+void page_alloc_init(PageIdAllocator *ids, size_t reuse_distance) {
+    memset(ids, 0, sizeof(*ids));
+    ids->next = 1;
+    ids->reuse_distance = reuse_distance;
+}
+
+sim_pageid_t page_alloc_take(PageIdAllocator *ids, uint32_t num_pages) {
+    int reuse = ids->reuse_distance != PAGE_ALLOC_NO_REUSE;
+    uint64_t first = ids->next;
+    if (reuse) {
+        if (!ids->words) {
+            tree_grow(ids, 1);
+        }
+        pending_collect(ids);
+        first = tree_find(ids, num_pages);
+    }
+    if (first + num_pages > UINT32_MAX) {
+        fprintf(stderr, "Page ids exhausted: the trace needs more than %u page ids\n", UINT32_MAX - 1);
+        exit(EXIT_FAILURE);
+    }
+    if (reuse) {
+        tree_grow(ids, first + num_pages);
+        bits_assign(ids, first, num_pages, 1);
+    }
+    if (first + num_pages > ids->next) {
+        ids->next = (sim_pageid_t)(first + num_pages);
+    }
+    ids->allocated += num_pages;
+    return (sim_pageid_t)first;
+}
+
+void page_alloc_release(PageIdAllocator *ids, sim_pageid_t first_page, uint32_t num_pages) {
+    if (ids->reuse_distance == PAGE_ALLOC_NO_REUSE || num_pages == 0) {
+        return;
+    }
+    if (ids->pending_count == ids->pending_capacity) {
+        // Primero recupera el espacio de los ya pasados a libres
+        if (ids->pending_head > 0) {
+            ids->pending_count -= ids->pending_head;
+            memmove(ids->pending, ids->pending + ids->pending_head, ids->pending_count * sizeof(PageIdRange));
+            ids->pending_head = 0;
+        }
+        if (ids->pending_count * 2 >= ids->pending_capacity) {
+            ids->pending_capacity = ids->pending_capacity ? ids->pending_capacity * 2 : 64;
+            ids->pending = page_alloc_realloc(ids->pending, ids->pending_capacity * sizeof(PageIdRange));
+        }
+    }
+    PageIdRange *range = &ids->pending[ids->pending_count++];
+    range->first_page = first_page;
+    range->num_pages = num_pages;
+    range->ready_at = ids->allocated + ids->reuse_distance;
+}
+
+void page_alloc_reset(PageIdAllocator *ids) {
+    ids->next = 1;
+    ids->allocated = 0;
+    ids->pending_head = 0;
+    ids->pending_count = 0;
+    if (ids->words) {
+        memset(ids->used, 0, ids->words * sizeof(uint64_t));
+        ids->used[0] = 1;
+        tree_update(ids, 0, ids->words - 1);
+    }
+}
+
+void page_alloc_free(PageIdAllocator *ids) {
+    free(ids->pending);
+    free(ids->used);
+    free(ids->run_pre);
+    free(ids->run_suf);
+    free(ids->run_best);
+    page_alloc_init(ids, ids->reuse_distance);
+}
@@ -0,0 +1,293 @@
+#include "pipeline.h"
+#include "util.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+// Reintentos cediendo la CPU antes de dormir en la variable de condición.
+#define PIPELINE_SPIN 128
+#define CACHE_LINE 64
+
+typedef enum ItemKind {
+    ITEM_INSTR,      // instrucción (con su traducción en el segundo anillo)
+    ITEM_RELEASE,    // rango liberado por la última ITEM_INSTR
+    ITEM_END         // fin de la fuente; status dice si terminó bien
+} ItemKind;
+
+typedef struct PipeItem {
+    ItemKind kind;
+    int status;
+    Instruction ins;
+    PageSpan span;           // acceso en ITEM_INSTR, rango en ITEM_RELEASE
+    size_t release_count;    // ITEM_RELEASE que siguen a esta ITEM_INSTR
+} PipeItem;
+
+// Anillo de un productor y un consumidor. head solo lo escribe el productor y tail el consumidor,
+// cada uno en su línea de caché; cada lado guarda una copia del índice ajeno y solo relee el
+// atómico cuando esa copia ya no alcanza. Quien no puede avanzar cede la CPU unas vueltas y después
+// duerme en cond; el otro lado solo toma el mutex si hay alguien durmiendo. El relleno separa los
+// campos de cada lado aunque malloc no alinee la estructura a la línea.
+typedef struct SpscRing {
+    char pad0[CACHE_LINE];
+    atomic_size_t head;
+    size_t cached_tail;      // del productor
+    char pad1[CACHE_LINE];
+    atomic_size_t tail;
+    size_t cached_head;      // del consumidor
+    char pad2[CACHE_LINE];
+    PipeItem *slots;
+    size_t mask;
+    atomic_int closed;       // pipeline_stop: nadie vuelve a esperar
+    atomic_int sleepers;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} SpscRing;
+
+struct Pipeline {
+    SpscRing read_ring;      // lector -> traductor
+    SpscRing event_ring;     // traductor -> administrador
+    InstrSourceFn source;
+    void *source_ctx;
+    EventBuilder builder;
+    pthread_t reader;
+    pthread_t translator;
+    PageSpan *released;      // rangos de la instrucción entregada por pipeline_next
+    size_t released_capacity;
+    int finished;
+    int status;
+};
+
+static void ring_init(SpscRing *ring, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->cached_tail = 0;
+    ring->cached_head = 0;
+    ring->slots = xmalloc(size * sizeof(PipeItem));
+    ring->mask = size - 1;
+    atomic_init(&ring->closed, 0);
+    atomic_init(&ring->sleepers, 0);
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+}
+
+static void ring_free(SpscRing *ring) {
+    free(ring->slots);
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->cond);
+}
+
+// Despierta al otro lado si está dormido. La barrera ordena la publicación del índice antes de leer
+// sleepers; quien duerme la incrementa bajo el mutex antes de volver a mirar el índice.
+static void ring_wake(SpscRing *ring) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->sleepers, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(&ring->cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+static void ring_close(SpscRing *ring) {
+    atomic_store(&ring->closed, 1);
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+// Espera hasta que ready(ring) sea verdadero; devuelve 0 si el anillo se cerró antes.
+static int ring_wait(SpscRing *ring, int (*ready)(SpscRing *)) {
+    for (int spin = 0; spin < PIPELINE_SPIN; ++spin) {
+        if (ready(ring)) {
+            return 1;
+        }
+        if (atomic_load_explicit(&ring->closed, memory_order_relaxed)) {
+            return 0;
+        }
+        sched_yield();
+    }
+    pthread_mutex_lock(&ring->lock);
+    atomic_fetch_add(&ring->sleepers, 1);
+    int ok;
+    for (;;) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if ((ok = ready(ring)) || atomic_load(&ring->closed)) {
+            break;
+        }
+        pthread_cond_wait(&ring->cond, &ring->lock);
+    }
+    atomic_fetch_sub(&ring->sleepers, 1);
+    pthread_mutex_unlock(&ring->lock);
+    return ok;
+}
+
+// Hay lugar para el productor; refresca su copia de tail solo si la vieja indica lleno
+static int ring_has_space(SpscRing *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - ring->cached_tail <= ring->mask) {
+        return 1;
+    }
+    ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - ring->cached_tail <= ring->mask;
+}
+
+// Hay datos para el consumidor; refresca su copia de head solo si la vieja indica vacío
+static int ring_has_data(SpscRing *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (ring->cached_head != tail) {
+        return 1;
+    }
+    ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return ring->cached_head != tail;
+}
+
+// Encola un elemento; devuelve 0 si el anillo se cerró
+static int ring_push(SpscRing *ring, const PipeItem *item) {
+    if (!ring_has_space(ring) && !ring_wait(ring, ring_has_space)) {
+        return 0;
+    }
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ring->slots[head & ring->mask] = *item;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    ring_wake(ring);
+    return 1;
+}
+
+// Desencola un elemento; devuelve 0 si el anillo se cerró
+static int ring_pop(SpscRing *ring, PipeItem *item) {
+    if (!ring_has_data(ring) && !ring_wait(ring, ring_has_data)) {
+        return 0;
+    }
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    *item = ring->slots[tail & ring->mask];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    ring_wake(ring);
+    return 1;
+}
+
+// Etapa 1: saca instrucciones de la fuente hasta el final o un error
+static void *reader_main(void *arg) {
+    Pipeline *pipeline = arg;
+    PipeItem item;
+    memset(&item, 0, sizeof(item));
+    for (;;) {
+        int status = pipeline->source(pipeline->source_ctx, &item.ins);
+        item.kind = status > 0 ? ITEM_INSTR : ITEM_END;
+        item.status = status < 0 ? -1 : 0;
+        if (!ring_push(&pipeline->read_ring, &item) || item.kind == ITEM_END) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// Etapa 2: traduce cada instrucción a páginas; los rangos liberados van detrás como ITEM_RELEASE
+static void *translator_main(void *arg) {
+    Pipeline *pipeline = arg;
+    PipeItem item;
+    while (ring_pop(&pipeline->read_ring, &item)) {
+        if (item.kind == ITEM_END) {
+            ring_push(&pipeline->event_ring, &item);
+            break;
+        }
+        item.span = event_builder_next(&pipeline->builder, &item.ins);
+        item.release_count = pipeline->builder.released_count;
+        if (!ring_push(&pipeline->event_ring, &item)) {
+            break;
+        }
+        PipeItem release;
+        memset(&release, 0, sizeof(release));
+        release.kind = ITEM_RELEASE;
+        size_t r = 0;
+        for (; r < pipeline->builder.released_count; ++r) {
+            release.span = pipeline->builder.released[r];
+            if (!ring_push(&pipeline->event_ring, &release)) {
+                break;
+            }
+        }
+        if (r < pipeline->builder.released_count) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+Pipeline *pipeline_start(InstrSourceFn source, void *ctx, size_t page_size, size_t window, size_t ring_capacity) {
+    if (!source) {
+        return NULL;
+    }
+    if (ring_capacity == 0) {
+        ring_capacity = PIPELINE_DEFAULT_RING;
+    }
+    Pipeline *pipeline = xmalloc(sizeof(Pipeline));
+    memset(pipeline, 0, sizeof(*pipeline));
+    ring_init(&pipeline->read_ring, ring_capacity);
+    ring_init(&pipeline->event_ring, ring_capacity);
+    pipeline->source = source;
+    pipeline->source_ctx = ctx;
+    event_builder_init(&pipeline->builder, page_size, sim_manager_page_reuse_distance(window));
+    if (pthread_create(&pipeline->reader, NULL, reader_main, pipeline) != 0 ||
+        pthread_create(&pipeline->translator, NULL, translator_main, pipeline) != 0) {
+        fprintf(stderr, "Cannot start pipeline thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return pipeline;
+}
+
+int pipeline_next(void *ctx, TranslatedInstr *out) {
+    Pipeline *pipeline = ctx;
+    if (pipeline->finished) {
+        return pipeline->status;
+    }
+    PipeItem item;
+    if (!ring_pop(&pipeline->event_ring, &item)) {
+        pipeline->finished = 1;
+        pipeline->status = -1;
+        return -1;
+    }
+    if (item.kind == ITEM_END) {
+        pipeline->finished = 1;
+        pipeline->status = item.status;
+        return item.status;
+    }
+
+    if (item.release_count > pipeline->released_capacity) {
+        pipeline->released_capacity = item.release_count * 2;
+        free(pipeline->released);
+        pipeline->released = xmalloc(pipeline->released_capacity * sizeof(PageSpan));
+    }
+    for (size_t r = 0; r < item.release_count; ++r) {
+        PipeItem release;
+        if (!ring_pop(&pipeline->event_ring, &release)) {
+            pipeline->finished = 1;
+            pipeline->status = -1;
+            return -1;
+        }
+        pipeline->released[r] = release.span;
+    }
+    out->ins = item.ins;
+    out->access = item.span;
+    out->released = pipeline->released;
+    out->released_count = item.release_count;
+    return 1;
+}
+
+void pipeline_stop(Pipeline *pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    ring_close(&pipeline->read_ring);
+    ring_close(&pipeline->event_ring);
+    pthread_join(pipeline->reader, NULL);
+    pthread_join(pipeline->translator, NULL);
+    ring_free(&pipeline->read_ring);
+    ring_free(&pipeline->event_ring);
+    event_builder_free(&pipeline->builder);
+    free(pipeline->released);
+    free(pipeline);
+}
@@ -0,0 +1,90 @@
+#include "replacement_policy.h"
+#include "util.h"
+
+#include <dlfcn.h>
+#include <string.h>
+
+// Módulo de política abierto con dlopen.
+typedef struct PolicyModule {
+    void *handle;
+    const ReplacementPolicy *policy;
+    struct PolicyModule *next;
+} PolicyModule;
+
+static PolicyModule *loaded_modules = NULL;
+
+// Busca una política por nombre: primero las integradas y luego los módulos cargados.
+const ReplacementPolicy *policy_find(const char *name) {
+    if (!name) {
+        return NULL;
+    }
+    for (int type = ALG_OPT; type <= ALG_RND; ++type) {
+        const ReplacementPolicy *policy = policy_builtin((AlgorithmType)type);
+        if (policy && strcmp(policy->name, name) == 0) {
+            return policy;
+        }
+    }
+    for (PolicyModule *module = loaded_modules; module; module = module->next) {
+        if (strcmp(module->policy->name, name) == 0) {
+            return module->policy;
+        }
+    }
+    return NULL;
+}
+
+// Abre el módulo, valida la tabla que exporta y la agrega al registro.
+const ReplacementPolicy *policy_load_module(const char *path, char *err, size_t err_size) {
+    if (err && err_size) {
+        err[0] = '\0';
+    }
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        if (err) {
+            snprintf(err, err_size, "%s", dlerror());
+        }
+        return NULL;
+    }
+
+    ReplacementPolicyEntryFn entry;
+    // dlsym devuelve void*; se copia para convertirlo a puntero a función sin advertencias
+    void *symbol = dlsym(handle, REPLACEMENT_POLICY_ENTRY);
+    memcpy(&entry, &symbol, sizeof(entry));
+    const ReplacementPolicy *policy = entry ? entry() : NULL;
+
+    const char *problem = NULL;
+    if (!entry) {
+        problem = "missing " REPLACEMENT_POLICY_ENTRY " symbol";
+    } else if (!policy) {
+        problem = REPLACEMENT_POLICY_ENTRY " returned no policy";
+    } else if (policy->api_version != REPLACEMENT_POLICY_API_VERSION) {
+        problem = "incompatible policy API version";
+    } else if (!policy->name || !policy->choose) {
+        problem = "policy must define name and choose";
+    } else if (policy_find(policy->name)) {
+        problem = "a policy with that name is already registered";
+    }
+    if (problem) {
+        if (err) {
+            snprintf(err, err_size, "%s: %s", path, problem);
+        }
+        dlclose(handle);
+        return NULL;
+    }
+
+    PolicyModule *module = xmalloc(sizeof(*module));
+    module->handle = handle;
+    module->policy = policy;
+    module->next = loaded_modules;
+    loaded_modules = module;
+    return policy;
+}
+
+// Cierra los módulos en orden inverso de carga.
+void policy_unload_modules(void) {
+    while (loaded_modules) {
+        PolicyModule *next = loaded_modules->next;
+        dlclose(loaded_modules->handle);
+        free(loaded_modules);
+        loaded_modules = next;
+    }
+}
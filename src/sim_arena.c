@@ -0,0 +1,178 @@
+#include "sim_arena.h"
+#include "util.h"
+
+#include <string.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_CLASS_BYTES 16
+
+struct ArenaChunk {
+    ArenaChunk *next;
+    size_t size;             // bytes utilizables en data
+    size_t used;
+    size_t pad;              // mantiene data alineado a 16 bytes
+    unsigned char data[];
+};
+
+// Redondea un tamaño al múltiplo de alineación de la arena.
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Reserva un bloque nuevo con al menos min_size bytes utilizables.
+static ArenaChunk *chunk_create(SimArena *arena, size_t min_size) {
+    size_t size = arena->chunk_size > min_size ? arena->chunk_size : min_size;
+    ArenaChunk *chunk = xmalloc(sizeof(ArenaChunk) + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    arena->bytes_reserved += sizeof(ArenaChunk) + size;
+    return chunk;
+}
+
+void arena_init(SimArena *arena, size_t chunk_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->chunk_size = chunk_size ? align_up(chunk_size) : ARENA_CHUNK_SIZE;
+}
+
+void *arena_alloc(SimArena *arena, size_t size) {
+    size = align_up(size ? size : 1);
+    if (!arena->current) {
+        if (!arena->head) {
+            arena->head = chunk_create(arena, size);
+        }
+        arena->current = arena->head;
+    }
+
+    // Avanza por los bloques conservados tras un reset antes de pedir uno nuevo
+    while (arena->current->used + size > arena->current->size) {
+        ArenaChunk *next = arena->current->next;
+        if (!next) {
+            next = chunk_create(arena, size);
+            arena->current->next = next;
+        } else if (next->size < size) {
+            // Bloque reutilizable demasiado chico: se inserta uno nuevo delante
+            ArenaChunk *fresh = chunk_create(arena, size);
+            fresh->next = next;
+            arena->current->next = fresh;
+            next = fresh;
+        }
+        arena->current = next;
+    }
+
+    void *ptr = arena->current->data + arena->current->used;
+    arena->current->used += size;
+    arena->bytes_used += size;
+    if (arena->bytes_used > arena->high_water) {
+        arena->high_water = arena->bytes_used;
+    }
+    return ptr;
+}
+
+void arena_reset(SimArena *arena) {
+    for (ArenaChunk *chunk = arena->head; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    arena->current = arena->head;
+    arena->bytes_used = 0;
+}
+
+void arena_release(SimArena *arena) {
+    ArenaChunk *chunk = arena->head;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = 0;
+}
+
+void slab_init(SimSlab *slab, SimArena *arena, size_t object_size) {
+    slab->arena = arena;
+    slab->object_size = object_size < sizeof(void *) ? sizeof(void *) : object_size;
+    slab->free_list = NULL;
+    slab->live = 0;
+    slab->peak = 0;
+}
+
+void *slab_alloc(SimSlab *slab) {
+    void *obj = slab->free_list;
+    if (obj) {
+        slab->free_list = *(void **)obj;
+    } else {
+        obj = arena_alloc(slab->arena, slab->object_size);
+    }
+    slab->live++;
+    if (slab->live > slab->peak) {
+        slab->peak = slab->live;
+    }
+    return obj;
+}
+
+void slab_free(SimSlab *slab, void *obj) {
+    if (!obj) {
+        return;
+    }
+    *(void **)obj = slab->free_list;
+    slab->free_list = obj;
+    if (slab->live > 0) {
+        slab->live--;
+    }
+}
+
+void slab_reset(SimSlab *slab) {
+    slab->free_list = NULL;
+    slab->live = 0;
+}
+
+// Devuelve la clase de tamaño más chica capaz de contener bytes bytes.
+static size_t pool_class_index(size_t bytes) {
+    size_t index = 0;
+    size_t class_bytes = ARENA_MIN_CLASS_BYTES;
+    while (class_bytes < bytes && index + 1 < ARENA_SIZE_CLASSES) {
+        class_bytes <<= 1;
+        ++index;
+    }
+    return index;
+}
+
+void pool_init(SimArrayPool *pool, SimArena *arena) {
+    for (size_t i = 0; i < ARENA_SIZE_CLASSES; ++i) {
+        slab_init(&pool->classes[i], arena, (size_t)ARENA_MIN_CLASS_BYTES << i);
+    }
+}
+
+void *pool_alloc(SimArrayPool *pool, size_t bytes) {
+    return slab_alloc(&pool->classes[pool_class_index(bytes)]);
+}
+
+void pool_free(SimArrayPool *pool, void *ptr, size_t bytes) {
+    if (!ptr) {
+        return;
+    }
+    slab_free(&pool->classes[pool_class_index(bytes)], ptr);
+}
+
+void *pool_realloc(SimArrayPool *pool, void *ptr, size_t old_bytes, size_t new_bytes) {
+    if (!ptr) {
+        return pool_alloc(pool, new_bytes);
+    }
+    size_t old_class = pool_class_index(old_bytes);
+    size_t new_class = pool_class_index(new_bytes);
+    if (old_class == new_class) {
+        return ptr;
+    }
+    void *fresh = slab_alloc(&pool->classes[new_class]);
+    memcpy(fresh, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+    slab_free(&pool->classes[old_class], ptr);
+    return fresh;
+}
+
+void pool_reset(SimArrayPool *pool) {
+    for (size_t i = 0; i < ARENA_SIZE_CLASSES; ++i) {
+        slab_reset(&pool->classes[i]);
+    }
+}
@@ -1,12 +1,13 @@
 #include "sim_engine.h"
 #include "algorithms.h"
+#include "policy_builtin.h"
+#include "replacement_policy.h"
 #include "util.h"
 
 #include <limits.h>
 #include <string.h>
 
 #define PROCESS_TABLE_INITIAL 16
-#define PTR_TABLE_INITIAL 64
 #define PAGE_TABLE_INITIAL 128
 
 typedef struct
@@ -53,11 +54,20 @@ static inline void record_page_fault(Simulator *sim, int account_thrashing)
     }
 }
 
+// Reserva la tabla de marcos y la pila de libres según la cantidad configurada.
+static void mmu_allocate_frames(MMU *mmu, size_t frame_count, size_t page_size)
+{
+    mmu->frame_count = frame_count ? frame_count : DEFAULT_RAM_FRAMES;
+    mmu->page_size = page_size ? page_size : DEFAULT_PAGE_SIZE;
+    mmu->frames = xmalloc(mmu->frame_count * sizeof(Frame));
+    mmu->free_frames = xmalloc(mmu->frame_count * sizeof(int));
+}
+
 // Marca todos los marcos como libres y rellena la pila de disponibles.
 static void mmu_initialize_frames(MMU *mmu)
 {
     mmu->free_count = 0;
-    for (int i = 0; i < RAM_FRAMES; ++i)
+    for (int i = 0; i < (int)mmu->frame_count; ++i)
     {
         mmu->frames[i].occupied = 0;
         mmu->frames[i].page_id = 0;
@@ -65,25 +75,51 @@ static void mmu_initialize_frames(MMU *mmu)
     }
 }
 
-// Amplía la tabla de páginas para aceptar el identificador solicitado.
+// Amplía cada arreglo de la tabla de páginas para aceptar el identificador solicitado.
 static void mmu_ensure_page_capacity(MMU *mmu, sim_pageid_t id)
 {
+    PageTable *pt = &mmu->pages;
     size_t needed = (size_t)id + 1;
-    if (needed <= mmu->pages_capacity)
+    if (needed <= pt->capacity)
     {
         return;
     }
-    size_t new_capacity = mmu->pages_capacity ? mmu->pages_capacity * 2 : PAGE_TABLE_INITIAL;
+    size_t new_capacity = pt->capacity ? pt->capacity * 2 : PAGE_TABLE_INITIAL;
     while (new_capacity < needed)
     {
         new_capacity *= 2;
     }
-    mmu->pages = sim_realloc(mmu->pages, new_capacity * sizeof(Page *));
-    for (size_t i = mmu->pages_capacity; i < new_capacity; ++i)
-    {
-        mmu->pages[i] = NULL;
-    }
-    mmu->pages_capacity = new_capacity;
+    size_t old = pt->capacity;
+    size_t added = new_capacity - old;
+    pt->live = sim_realloc(pt->live, new_capacity * sizeof(*pt->live));
+    pt->in_ram = sim_realloc(pt->in_ram, new_capacity * sizeof(*pt->in_ram));
+    pt->ref_bit = sim_realloc(pt->ref_bit, new_capacity * sizeof(*pt->ref_bit));
+    pt->frame_index = sim_realloc(pt->frame_index, new_capacity * sizeof(*pt->frame_index));
+    pt->last_used = sim_realloc(pt->last_used, new_capacity * sizeof(*pt->last_used));
+    pt->next_use_pos = sim_realloc(pt->next_use_pos, new_capacity * sizeof(*pt->next_use_pos));
+    pt->owner_pid = sim_realloc(pt->owner_pid, new_capacity * sizeof(*pt->owner_pid));
+    pt->owner_ptr = sim_realloc(pt->owner_ptr, new_capacity * sizeof(*pt->owner_ptr));
+    pt->page_index = sim_realloc(pt->page_index, new_capacity * sizeof(*pt->page_index));
+    pt->future_cursor = sim_realloc(pt->future_cursor, new_capacity * sizeof(*pt->future_cursor));
+    memset(pt->live + old, 0, added * sizeof(*pt->live));
+    pt->capacity = new_capacity;
+}
+
+// Libera los arreglos de la tabla de páginas.
+static void mmu_free_page_table(MMU *mmu)
+{
+    PageTable *pt = &mmu->pages;
+    free(pt->live);
+    free(pt->in_ram);
+    free(pt->ref_bit);
+    free(pt->frame_index);
+    free(pt->last_used);
+    free(pt->next_use_pos);
+    free(pt->owner_pid);
+    free(pt->owner_ptr);
+    free(pt->page_index);
+    free(pt->future_cursor);
+    memset(pt, 0, sizeof(*pt));
 }
 
 // Reserva espacio en la tabla de procesos hasta cubrir el pid pedido.
@@ -107,27 +143,6 @@ static void ensure_process_capacity(Simulator *sim, sim_pid_t pid)
     sim->process_capacity = new_capacity;
 }
 
-// Amplía la tabla global de punteros hasta incluir el identificador dado.
-static void ensure_ptr_table_capacity(Simulator *sim, sim_ptr_t ptr_id)
-{
-    size_t needed = (size_t)ptr_id + 1;
-    if (needed <= sim->ptr_table_capacity)
-    {
-        return;
-    }
-    size_t new_capacity = sim->ptr_table_capacity ? sim->ptr_table_capacity * 2 : PTR_TABLE_INITIAL;
-    while (new_capacity < needed)
-    {
-        new_capacity *= 2;
-    }
-    sim->ptr_table = sim_realloc(sim->ptr_table, new_capacity * sizeof(PtrMap *));
-    for (size_t i = sim->ptr_table_capacity; i < new_capacity; ++i)
-    {
-        sim->ptr_table[i] = NULL;
-    }
-    sim->ptr_table_capacity = new_capacity;
-}
-
 // Obtiene el proceso solicitado y lo crea si la bandera 'create' está activa.
 static Process *sim_get_process(Simulator *sim, sim_pid_t pid, int create)
 {
@@ -139,7 +154,7 @@ static Process *sim_get_process(Simulator *sim, sim_pid_t pid, int create)
     Process *proc = sim->processes[pid];
     if (!proc && create)
     {
-        proc = xmalloc(sizeof(*proc));
+        proc = slab_alloc(&sim->process_slab);
         proc->pid = pid;
         proc->ptrs = NULL;
         proc->ptr_count = 0;
@@ -154,11 +169,8 @@ static Process *sim_get_process(Simulator *sim, sim_pid_t pid, int create)
 // Busca una estructura PtrMap asociada al identificador global dado.
 static PtrMap *sim_lookup_ptrmap(const Simulator *sim, sim_ptr_t ptr_id)
 {
-    if (ptr_id == 0 || ptr_id >= sim->ptr_table_capacity)
-    {
-        return NULL;
-    }
-    return sim->ptr_table[ptr_id];
+    const uint64_t *value = id_map_find(&sim->ptr_table, ptr_id);
+    return value ? (PtrMap *)(uintptr_t)*value : NULL;
 }
 
 // Recupera un puntero y su proceso dueño para operaciones posteriores.
@@ -179,38 +191,23 @@ static PtrLookupResult sim_lookup_ptr(Simulator *sim, sim_ptr_t ptr_id)
 // Registra un PtrMap en la tabla global para permitir búsquedas rápidas.
 static void sim_register_ptrmap(Simulator *sim, PtrMap *ptr)
 {
-    ensure_ptr_table_capacity(sim, ptr->id);
-    if (!sim->ptr_table[ptr->id])
-    {
-        sim->ptr_table_count++;
-    }
-    sim->ptr_table[ptr->id] = ptr;
+    id_map_put(&sim->ptr_table, ptr->id, (uint64_t)(uintptr_t)ptr);
 }
 
 // Elimina la referencia al PtrMap cuando deja de existir en la simulación.
 static void sim_unregister_ptrmap(Simulator *sim, sim_ptr_t ptr_id)
 {
-    if (ptr_id == 0 || ptr_id >= sim->ptr_table_capacity)
-    {
-        return;
-    }
-    if (sim->ptr_table[ptr_id])
-    {
-        sim->ptr_table[ptr_id] = NULL;
-        if (sim->ptr_table_count > 0)
-        {
-            sim->ptr_table_count--;
-        }
-    }
+    id_map_remove(&sim->ptr_table, ptr_id);
 }
 
 // Inserta un PtrMap en la lista del proceso expandiendo memoria si es necesario.
-static void process_add_ptr(Process *proc, PtrMap *ptr)
+static void process_add_ptr(Simulator *sim, Process *proc, PtrMap *ptr)
 {
     if (proc->ptr_count == proc->ptr_capacity)
     {
         size_t new_capacity = proc->ptr_capacity ? proc->ptr_capacity * 2 : 4;
-        proc->ptrs = sim_realloc(proc->ptrs, new_capacity * sizeof(PtrMap *));
+        proc->ptrs = pool_realloc(&sim->arrays, proc->ptrs, proc->ptr_capacity * sizeof(PtrMap *),
+                                  new_capacity * sizeof(PtrMap *));
         proc->ptr_capacity = new_capacity;
     }
     proc->ptrs[proc->ptr_count++] = ptr;
@@ -235,37 +232,31 @@ static void process_remove_ptr(Process *proc, PtrMap *ptr)
     }
 }
 
-// Devuelve la página asociada a un id si existe en la tabla del MMU.
-static Page *sim_get_page(const Simulator *sim, sim_pageid_t page_id)
+// Indica si el id corresponde a una página existente en la tabla del MMU.
+static inline int sim_page_exists(const Simulator *sim, sim_pageid_t page_id)
 {
-    if (page_id == 0 || page_id >= sim->mmu.pages_capacity)
-    {
-        return NULL;
-    }
-    return sim->mmu.pages[page_id];
+    return page_id != 0 && page_id < sim->mmu.pages.capacity && sim->mmu.pages.live[page_id];
 }
 
 // Borra la entrada de la tabla de páginas y actualiza el conteo global.
-static void mmu_remove_page_entry(Simulator *sim, Page *page)
+static void mmu_remove_page_entry(Simulator *sim, sim_pageid_t page_id)
 {
-    if (!page)
+    PageTable *pt = &sim->mmu.pages;
+    if (!sim_page_exists(sim, page_id))
     {
         return;
     }
-    if (page->id < sim->mmu.pages_capacity && sim->mmu.pages[page->id])
+    pt->live[page_id] = 0;
+    if (pt->count > 0)
     {
-        sim->mmu.pages[page->id] = NULL;
-        if (sim->mmu.page_count > 0)
-        {
-            sim->mmu.page_count--;
-        }
+        pt->count--;
     }
 }
 
 // Marca un marco como libre y lo devuelve a la pila de disponibles.
 static void mmu_release_frame(MMU *mmu, int frame_index)
 {
-    if (frame_index < 0 || frame_index >= RAM_FRAMES)
+    if (frame_index < 0 || (size_t)frame_index >= mmu->frame_count)
     {
         return;
     }
@@ -287,58 +278,33 @@ static int mmu_pop_free_frame(MMU *mmu)
     return mmu->free_frames[--mmu->free_count];
 }
 
-// Libera la cola de usos futuros asociada a una página OPT.
-static void destroy_future_queue(FutureUseQueue *queue)
-{
-    if (queue->positions)
-    {
-        free(queue->positions);
-    }
-    memset(queue, 0, sizeof(*queue));
-}
-
-// Destruye la estructura de página y su cola auxiliar.
-static void destroy_page(Simulator *sim, Page *page)
-{
-    (void)sim;
-    if (!page)
-    {
-        return;
-    }
-    destroy_future_queue(&page->future_uses);
-    free(page);
-}
 
 // Saca a la página de RAM o swap y libera su marco si correspondía.
-static void detach_page_from_memory(Simulator *sim, Page *page)
+static void detach_page_from_memory(Simulator *sim, sim_pageid_t page_id)
 {
-    if (!page)
+    PageTable *pt = &sim->mmu.pages;
+    if (pt->in_ram[page_id] && pt->frame_index[page_id] >= 0)
     {
-        return;
-    }
-    if (page->in_ram && page->frame_index >= 0)
-    {
-        algorithms_on_page_evicted(sim, page);
-        mmu_release_frame(&sim->mmu, page->frame_index);
+        algorithms_on_page_evicted(sim, page_id);
+        mmu_release_frame(&sim->mmu, pt->frame_index[page_id]);
     }
-    else if (!page->in_ram && sim->total_pages_in_swap > 0)
+    else if (!pt->in_ram[page_id] && sim->total_pages_in_swap > 0)
     {
         sim->total_pages_in_swap--;
     }
-    page->in_ram = 0;
-    page->frame_index = -1;
+    pt->in_ram[page_id] = 0;
+    pt->frame_index[page_id] = -1;
 }
 
 // Elimina una página de todas las estructuras de seguimiento.
-static void remove_page_completely(Simulator *sim, Page *page)
+static void remove_page_completely(Simulator *sim, sim_pageid_t page_id)
 {
-    if (!page)
+    if (!sim_page_exists(sim, page_id))
     {
         return;
     }
-    detach_page_from_memory(sim, page);
-    mmu_remove_page_entry(sim, page);
-    destroy_page(sim, page);
+    detach_page_from_memory(sim, page_id);
+    mmu_remove_page_entry(sim, page_id);
 }
 
 // Destruye un PtrMap liberando sus páginas asociadas y ajustando estadísticas.
@@ -355,7 +321,7 @@ static void remove_ptrmap(Simulator *sim, Process *proc, PtrMap *ptr)
         process_remove_ptr(proc, ptr);
     }
 
-    size_t wasted = (size_t)ptr->num_pages * PAGE_SIZE - ptr->byte_size;
+    size_t wasted = (size_t)ptr->num_pages * sim->mmu.page_size - ptr->byte_size;
     if (sim->internal_fragmentation_bytes >= wasted)
     {
         sim->internal_fragmentation_bytes -= wasted;
@@ -367,21 +333,17 @@ static void remove_ptrmap(Simulator *sim, Process *proc, PtrMap *ptr)
 
     for (uint32_t i = 0; i < ptr->num_pages; ++i)
     {
-        sim_pageid_t page_id = ptr->pages[i];
-        Page *page = sim_get_page(sim, page_id);
-        if (page)
-        {
-            remove_page_completely(sim, page);
-        }
+        remove_page_completely(sim, ptrmap_page_at(ptr, i));
     }
+    page_alloc_release(&sim->page_ids, ptr->first_page, ptr->num_pages);
 
-    free(ptr->pages);
-    free(ptr);
+    slab_free(&sim->ptrmap_slab, ptr);
 
     sim->stats.ptr_deletions++;
 }
 
 // Limpia todos los procesos, páginas y métricas del simulador.
+// Procesos, PtrMap y sus arreglos viven en la arena, así que se descartan en bloque.
 static void sim_clear_state(Simulator *sim, int free_arrays)
 {
     if (!sim)
@@ -389,50 +351,25 @@ static void sim_clear_state(Simulator *sim, int free_arrays)
         return;
     }
 
+    slab_reset(&sim->process_slab);
+    slab_reset(&sim->ptrmap_slab);
+    pool_reset(&sim->arrays);
+    arena_reset(&sim->arena);
+
     if (sim->processes)
     {
-        for (size_t pid = 0; pid < sim->process_capacity; ++pid)
-        {
-            Process *proc = sim->processes[pid];
-            if (!proc)
-            {
-                continue;
-            }
-            while (proc->ptr_count > 0)
-            {
-                PtrMap *ptr = proc->ptrs[proc->ptr_count - 1];
-                remove_ptrmap(sim, proc, ptr);
-            }
-            free(proc->ptrs);
-            free(proc);
-            sim->processes[pid] = NULL;
-        }
+        memset(sim->processes, 0, sim->process_capacity * sizeof(Process *));
     }
-
     sim->process_count = 0;
 
-    if (sim->mmu.pages)
+    PageTable *pt = &sim->mmu.pages;
+    if (pt->live)
     {
-        for (size_t idx = 0; idx < sim->mmu.pages_capacity; ++idx)
-        {
-            Page *page = sim->mmu.pages[idx];
-            if (page)
-            {
-                destroy_page(sim, page);
-                sim->mmu.pages[idx] = NULL;
-            }
-        }
+        memset(pt->live, 0, pt->capacity * sizeof(*pt->live));
     }
-    sim->mmu.page_count = 0;
+    pt->count = 0;
 
-    if (sim->ptr_table)
-    {
-        for (size_t i = 0; i < sim->ptr_table_capacity; ++i)
-        {
-            sim->ptr_table[i] = NULL;
-        }
-    }
-    sim->ptr_table_count = 0;
+    id_map_free(&sim->ptr_table);
 
     mmu_initialize_frames(&sim->mmu);
 
@@ -441,8 +378,9 @@ static void sim_clear_state(Simulator *sim, int free_arrays)
     sim->total_pages_in_swap = 0;
     sim->stats = (SimStats){0};
     sim->internal_fragmentation_bytes = 0;
-    sim->next_page_id = 1;
+    page_alloc_reset(&sim->page_ids);
     sim->next_ptr_id = 1;
+    rng_seed(&sim->rng, sim->rng_seed);
 
     algorithms_reset(sim);
 
@@ -452,122 +390,112 @@ static void sim_clear_state(Simulator *sim, int free_arrays)
         sim->processes = NULL;
         sim->process_capacity = 0;
 
-        free(sim->mmu.pages);
-        sim->mmu.pages = NULL;
-        sim->mmu.pages_capacity = 0;
+        mmu_free_page_table(&sim->mmu);
+        page_alloc_free(&sim->page_ids);
+
+        free(sim->mmu.frames);
+        sim->mmu.frames = NULL;
+        free(sim->mmu.free_frames);
+        sim->mmu.free_frames = NULL;
+        sim->mmu.free_count = 0;
+        sim->mmu.frame_count = 0;
 
-        free(sim->ptr_table);
-        sim->ptr_table = NULL;
-        sim->ptr_table_capacity = 0;
+        arena_release(&sim->arena);
     }
 }
 
-// Crea un nuevo PtrMap y reserva espacio para sus páginas virtuales.
+// Crea un nuevo PtrMap y le asigna el rango de ids de sus páginas virtuales.
 static PtrMap *create_ptrmap(Simulator *sim, Process *proc, sim_ptr_t ptr_id, size_t byte_size, uint32_t num_pages)
 {
-    (void)sim;
-    PtrMap *ptr = xmalloc(sizeof(*ptr));
+    PtrMap *ptr = slab_alloc(&sim->ptrmap_slab);
     ptr->id = ptr_id;
     ptr->owner_pid = proc ? proc->pid : 0;
     ptr->byte_size = (uint32_t)byte_size;
     ptr->num_pages = num_pages;
-    ptr->pages_capacity = num_pages;
-    ptr->pages = xmalloc(sizeof(sim_pageid_t) * num_pages);
-    memset(ptr->pages, 0, sizeof(sim_pageid_t) * num_pages);
+    ptr->first_page = page_alloc_take(&sim->page_ids, num_pages);
     return ptr;
 }
 
-static void load_future_use_data(Simulator *sim, Page *page)
+// Apunta el cursor de la página al inicio de su lista en el índice compartido de usos futuros.
+static void load_future_use_data(Simulator *sim, sim_pageid_t page_id)
 {
-    if (!sim || !page || !sim->future_dataset || !sim->future_dataset->entries)
-    {
+    PageTable *pt = &sim->mmu.pages;
+    const FutureUseIndex *index = sim->future_index;
+    pt->future_cursor[page_id] = 0;
+    pt->next_use_pos[page_id] = FUTURE_USE_NONE;
+    if (index && !index->positions)
+    {
+        // Modo ventana: el cursor es el primer uso en la ventana o FUTURE_USE_NONE
+        const uint64_t *first = id_map_find(&index->first_use, page_id);
+        pt->future_cursor[page_id] = first ? (uint32_t)*first : FUTURE_USE_NONE;
+        pt->next_use_pos[page_id] = pt->future_cursor[page_id];
         return;
     }
-    if (page->id >= sim->future_dataset->capacity)
+    if (!index || !index->offsets || page_id >= index->page_capacity)
     {
         return;
     }
-    const FutureUseEntry *entry = &sim->future_dataset->entries[page->id];
-    if (!entry || entry->count == 0 || !entry->positions)
+
+    size_t begin = index->offsets[page_id];
+    pt->future_cursor[page_id] = (uint32_t)begin;
+    if (begin < index->offsets[page_id + 1])
     {
-        page->future_uses = (FutureUseQueue){0};
-        page->next_use_pos = SIZE_MAX;
-        return;
+        pt->next_use_pos[page_id] = index->positions[begin];
     }
+}
 
-    page->future_uses.positions = xmalloc(entry->count * sizeof(size_t));
-    memcpy(page->future_uses.positions, entry->positions, entry->count * sizeof(size_t));
-    page->future_uses.count = entry->count;
-    page->future_uses.capacity = entry->count;
-    page->future_uses.cursor = 0;
-    page->next_use_pos = entry->positions[0];
-}
-
-// Construye una página virtual y la registra en la tabla global del MMU.
-static Page *create_page(Simulator *sim, sim_pid_t owner_pid, sim_ptr_t owner_ptr, uint32_t page_index)
-{
-    Page *page = xmalloc(sizeof(*page));
-    memset(page, 0, sizeof(*page));
-    page->id = sim->next_page_id++;
-    page->owner_pid = owner_pid;
-    page->owner_ptr = owner_ptr;
-    page->page_index = page_index;
-    page->in_ram = 0;
-    page->frame_index = -1;
-    page->ref_bit = 0;
-    page->dirty = 0;
-    page->last_used = 0;
-    page->next_use_pos = SIZE_MAX;
-    mmu_ensure_page_capacity(&sim->mmu, page->id);
-    sim->mmu.pages[page->id] = page;
-    sim->mmu.page_count++;
-    load_future_use_data(sim, page);
-    return page;
+// Construye la página virtual id del puntero y la registra en la tabla global del MMU.
+static sim_pageid_t create_page(Simulator *sim, sim_pageid_t id, sim_pid_t owner_pid, sim_ptr_t owner_ptr,
+                                uint32_t page_index)
+{
+    mmu_ensure_page_capacity(&sim->mmu, id);
+    PageTable *pt = &sim->mmu.pages;
+    pt->live[id] = 1;
+    pt->in_ram[id] = 0;
+    pt->ref_bit[id] = 0;
+    pt->frame_index[id] = -1;
+    pt->last_used[id] = 0;
+    pt->owner_pid[id] = owner_pid;
+    pt->owner_ptr[id] = owner_ptr;
+    pt->page_index[id] = page_index;
+    pt->count++;
+    load_future_use_data(sim, id);
+    return id;
 }
 
-// Ubica una página en un marco físico y notifica al algoritmo de reemplazo.
-static void place_page_in_frame(Simulator *sim, Page *page, int frame_index)
+// Ubica una página en un marco físico sin avisar a la política.
+static void install_page_in_frame(Simulator *sim, sim_pageid_t page_id, int frame_index)
 {
     MMU *mmu = &sim->mmu;
-    if (frame_index < 0 || frame_index >= RAM_FRAMES)
-    {
-        return;
-    }
     mmu->frames[frame_index].occupied = 1;
-    mmu->frames[frame_index].page_id = page->id;
-    page->in_ram = 1;
-    page->frame_index = frame_index;
-    page->ref_bit = 1;
-    page->last_used = sim->clock;
-    algorithms_on_page_loaded(sim, page);
+    mmu->frames[frame_index].page_id = page_id;
+    mmu->pages.in_ram[page_id] = 1;
+    mmu->pages.frame_index[page_id] = frame_index;
+    mmu->pages.ref_bit[page_id] = 1;
+    mmu->pages.last_used[page_id] = sim->clock;
 }
 
-// Recupera la estructura de la página candidata a ser expulsada.
-static Page *get_victim_page(Simulator *sim, sim_pageid_t victim_id)
+// Ubica una página en un marco físico y notifica al algoritmo de reemplazo.
+static void place_page_in_frame(Simulator *sim, sim_pageid_t page_id, int frame_index)
 {
-    Page *victim = sim_get_page(sim, victim_id);
-    if (!victim || !victim->in_ram)
+    if (frame_index < 0 || (size_t)frame_index >= sim->mmu.frame_count)
     {
-        return NULL;
+        return;
     }
-    return victim;
+    install_page_in_frame(sim, page_id, frame_index);
+    algorithms_on_page_loaded(sim, page_id);
 }
 
-// Determina qué página será desalojada según la política activa o una opción de respaldo.
-static sim_pageid_t select_victim_page(Simulator *sim)
+// Comprueba que la página candidata a ser expulsada exista y esté en RAM.
+static int is_valid_victim(const Simulator *sim, sim_pageid_t victim_id)
 {
-    sim_pageid_t candidate = choose_victim(sim);
-
-    if (candidate)
-    {
-        Page *page = get_victim_page(sim, candidate);
-        if (page)
-        {
-            return candidate;
-        }
-    }
+    return sim_page_exists(sim, victim_id) && sim->mmu.pages.in_ram[victim_id];
+}
 
-    for (int i = 0; i < RAM_FRAMES; ++i)
+// Devuelve la página del primer marco ocupado, víctima de respaldo si la política no elige una válida.
+static sim_pageid_t first_resident_page(const Simulator *sim)
+{
+    for (size_t i = 0; i < sim->mmu.frame_count; ++i)
     {
         if (sim->mmu.frames[i].occupied)
         {
@@ -578,22 +506,44 @@ static sim_pageid_t select_victim_page(Simulator *sim)
     return 0;
 }
 
+// Saca de RAM una víctima ya notificada a la política y contabiliza la expulsión.
+static void finish_eviction(Simulator *sim, sim_pageid_t victim_id)
+{
+    PageTable *pt = &sim->mmu.pages;
+    mmu_release_frame(&sim->mmu, pt->frame_index[victim_id]);
+    pt->in_ram[victim_id] = 0;
+    pt->frame_index[victim_id] = -1;
+    pt->ref_bit[victim_id] = 0;
+    pt->last_used[victim_id] = sim->clock;
+    sim->total_pages_in_swap++;
+    sim->stats.pages_evicted++;
+}
+
+// Determina qué página será desalojada según la política activa o una opción de respaldo.
+static sim_pageid_t select_victim_page(Simulator *sim)
+{
+    sim_pageid_t candidate = choose_victim(sim);
+
+    if (candidate && is_valid_victim(sim, candidate))
+    {
+        return candidate;
+    }
+
+    return first_resident_page(sim);
+}
+
 // Expulsa una página de RAM y devuelve el índice del marco liberado.
 static int evict_page(Simulator *sim)
 {
     sim_pageid_t victim_id = select_victim_page(sim);
-    Page *victim = get_victim_page(sim, victim_id);
-    if (!victim)
+    if (!is_valid_victim(sim, victim_id))
     {
         return -1;
     }
 
-    int frame_index = victim->frame_index;
-    detach_page_from_memory(sim, victim);
-    victim->ref_bit = 0;
-    victim->last_used = sim->clock;
-    sim->total_pages_in_swap++;
-    sim->stats.pages_evicted++;
+    int frame_index = sim->mmu.pages.frame_index[victim_id];
+    algorithms_on_page_evicted(sim, victim_id);
+    finish_eviction(sim, victim_id);
     return frame_index;
 }
 
@@ -627,13 +577,13 @@ static int acquire_frame(Simulator *sim, int *was_fault)
     return frame_index;
 }
 
-// Atiende la instrucción NEW reservando páginas para un proceso.
-static void handle_new(Simulator *sim, const Instruction *ins)
+// Registra el PtrMap de una instrucción NEW y su contabilidad; las páginas las crea el llamador.
+static PtrMap *begin_new_ptrmap(Simulator *sim, const Instruction *ins, Process **out_proc)
 {
     Process *proc = sim_get_process(sim, ins->pid, 1);
     if (!proc)
     {
-        return;
+        return NULL;
     }
 
     sim_ptr_t ptr_id = ins->ptr_id;
@@ -646,7 +596,8 @@ static void handle_new(Simulator *sim, const Instruction *ins)
         sim->next_ptr_id = ptr_id + 1;
     }
 
-    size_t num_pages = (ins->size + PAGE_SIZE - 1) / PAGE_SIZE;
+    size_t page_size = sim->mmu.page_size;
+    size_t num_pages = (ins->size + page_size - 1) / page_size;
     if (num_pages == 0)
     {
         num_pages = 1;
@@ -654,24 +605,37 @@ static void handle_new(Simulator *sim, const Instruction *ins)
 
     PtrMap *ptr = create_ptrmap(sim, proc, ptr_id, ins->size, (uint32_t)num_pages);
     sim_register_ptrmap(sim, ptr);
-    process_add_ptr(proc, ptr);
+    process_add_ptr(sim, proc, ptr);
 
-    size_t fragmentation = num_pages * PAGE_SIZE - ins->size;
+    size_t fragmentation = num_pages * page_size - ins->size;
     sim->internal_fragmentation_bytes += fragmentation;
     sim->stats.ptr_allocations++;
     sim->stats.bytes_requested += ins->size;
     sim->stats.pages_created += num_pages;
 
+    *out_proc = proc;
+    return ptr;
+}
+
+// Atiende la instrucción NEW reservando páginas para un proceso.
+static void handle_new(Simulator *sim, const Instruction *ins)
+{
+    Process *proc = NULL;
+    PtrMap *ptr = begin_new_ptrmap(sim, ins, &proc);
+    if (!ptr)
+    {
+        return;
+    }
+
     for (uint32_t i = 0; i < ptr->num_pages; ++i)
     {
-        Page *page = create_page(sim, proc->pid, ptr_id, i);
-        ptr->pages[i] = page->id;
+        sim_pageid_t page_id = create_page(sim, ptrmap_page_at(ptr, i), proc->pid, ptr->id, i);
 
         int was_fault = 0;
         int frame_index = acquire_frame(sim, &was_fault);
         if (frame_index < 0)
         {
-            log_debug("[sim] Unable to allocate frame for new page %u\n", page->id);
+            log_debug("[sim] Unable to allocate frame for new page %u\n", page_id);
             continue;
         }
 
@@ -684,8 +648,8 @@ static void handle_new(Simulator *sim, const Instruction *ins)
             record_page_hit(sim);
         }
 
-        place_page_in_frame(sim, page, frame_index);
-        algorithms_on_page_accessed(sim, page);
+        place_page_in_frame(sim, page_id, frame_index);
+        algorithms_on_page_accessed(sim, page_id);
     }
 }
 
@@ -699,21 +663,21 @@ static void handle_use(Simulator *sim, const Instruction *ins)
     }
 
     PtrMap *ptr = lookup.ptr;
+    PageTable *pt = &sim->mmu.pages;
     for (uint32_t i = 0; i < ptr->num_pages; ++i)
     {
-        sim_pageid_t page_id = ptr->pages[i];
-        Page *page = sim_get_page(sim, page_id);
-        if (!page)
+        sim_pageid_t page_id = ptrmap_page_at(ptr, i);
+        if (!sim_page_exists(sim, page_id))
         {
             continue;
         }
 
-        if (page->in_ram)
+        if (pt->in_ram[page_id])
         {
             record_page_hit(sim);
-            page->last_used = sim->clock;
-            page->ref_bit = 1;
-            algorithms_on_page_accessed(sim, page);
+            pt->last_used[page_id] = sim->clock;
+            pt->ref_bit[page_id] = 1;
+            algorithms_on_page_accessed(sim, page_id);
         }
         else
         {
@@ -732,12 +696,84 @@ static void handle_use(Simulator *sim, const Instruction *ins)
 
             record_page_fault(sim, 1);
 
-            place_page_in_frame(sim, page, frame_index);
-            algorithms_on_page_accessed(sim, page);
+            place_page_in_frame(sim, page_id, frame_index);
+            algorithms_on_page_accessed(sim, page_id);
         }
     }
 }
 
+// Bucles especializados por política integrada; las políticas externas usan handle_new/handle_use.
+#define POLICY opt
+#define POLICY_LOADED opt_on_loaded
+#define POLICY_EVICTED opt_on_evicted
+#define POLICY_ACCESSED opt_on_accessed
+#define POLICY_CHOOSE opt_choose
+#include "sim_engine_loops.inc"
+
+#define POLICY fifo
+#define POLICY_LOADED frame_list_policy_push
+#define POLICY_EVICTED frame_list_policy_unlink
+#define POLICY_ACCESSED policy_noop_hook
+#define POLICY_CHOOSE fifo_choose
+#include "sim_engine_loops.inc"
+
+#define POLICY sc
+#define POLICY_LOADED sc_on_loaded
+#define POLICY_EVICTED sc_on_evicted
+#define POLICY_ACCESSED sc_on_accessed
+#define POLICY_CHOOSE sc_choose
+#include "sim_engine_loops.inc"
+
+#define POLICY lru
+#define POLICY_LOADED frame_list_policy_push
+#define POLICY_EVICTED frame_list_policy_unlink
+#define POLICY_ACCESSED frame_list_policy_push
+#define POLICY_CHOOSE lru_choose
+#include "sim_engine_loops.inc"
+
+#define POLICY mru
+#define POLICY_LOADED frame_list_policy_push
+#define POLICY_EVICTED frame_list_policy_unlink
+#define POLICY_ACCESSED frame_list_policy_push
+#define POLICY_CHOOSE mru_choose
+#include "sim_engine_loops.inc"
+
+#define POLICY rnd
+#define POLICY_LOADED rnd_on_loaded
+#define POLICY_EVICTED rnd_on_evicted
+#define POLICY_ACCESSED policy_noop_hook
+#define POLICY_CHOOSE rnd_choose
+#include "sim_engine_loops.inc"
+
+typedef struct
+{
+    void (*handle_new)(Simulator *sim, const Instruction *ins);
+    void (*handle_use)(Simulator *sim, const Instruction *ins);
+} EngineLoops;
+
+// Bucles por AlgorithmType; ALG_CUSTOM y cualquier otro valor caen en generic_loops.
+static const EngineLoops builtin_loops[] = {
+    [ALG_OPT] = {handle_new_opt, handle_use_opt},
+    [ALG_FIFO] = {handle_new_fifo, handle_use_fifo},
+    [ALG_SC] = {handle_new_sc, handle_use_sc},
+    [ALG_LRU] = {handle_new_lru, handle_use_lru},
+    [ALG_MRU] = {handle_new_mru, handle_use_mru},
+    [ALG_RND] = {handle_new_rnd, handle_use_rnd},
+};
+
+static const EngineLoops generic_loops = {handle_new, handle_use};
+
+// Elige los bucles del simulador según su política activa.
+static const EngineLoops *engine_loops(const Simulator *sim)
+{
+    int type = (int)sim->algorithm;
+    if (type >= ALG_OPT && type <= ALG_RND && sim->alg_state)
+    {
+        return &builtin_loops[sim->algorithm];
+    }
+    return &generic_loops;
+}
+
 // Maneja la instrucción DELETE liberando la memoria asociada al puntero.
 static void handle_delete(Simulator *sim, const Instruction *ins)
 {
@@ -765,8 +801,8 @@ static void handle_kill(Simulator *sim, const Instruction *ins)
     }
 
     proc->killed = 1;
-    free(proc->ptrs);
-    free(proc);
+    pool_free(&sim->arrays, proc->ptrs, proc->ptr_capacity * sizeof(PtrMap *));
+    slab_free(&sim->process_slab, proc);
     sim->processes[ins->pid] = NULL;
     if (sim->process_count > 0)
     {
@@ -775,7 +811,8 @@ static void handle_kill(Simulator *sim, const Instruction *ins)
 }
 
 // Inicializa el simulador y deja listo el MMU y el algoritmo requerido.
-void sim_init(Simulator *sim, const char *name, AlgorithmType type)
+// frame_count y page_size en cero seleccionan DEFAULT_RAM_FRAMES y DEFAULT_PAGE_SIZE.
+void sim_init(Simulator *sim, const char *name, AlgorithmType type, size_t frame_count, size_t page_size)
 {
     if (!sim)
     {
@@ -788,11 +825,18 @@ void sim_init(Simulator *sim, const char *name, AlgorithmType type)
         strncpy(sim->name, name, sizeof(sim->name) - 1);
     }
     sim->algorithm = type;
-    sim->next_page_id = 1;
+    page_alloc_init(&sim->page_ids, PAGE_ALLOC_NO_REUSE);
     sim->next_ptr_id = 1;
     sim->rng_seed = 0;
-    sim->future_dataset = NULL;
+    rng_seed(&sim->rng, sim->rng_seed);
+    sim->future_index = NULL;
 
+    arena_init(&sim->arena, ARENA_CHUNK_SIZE);
+    slab_init(&sim->ptrmap_slab, &sim->arena, sizeof(PtrMap));
+    slab_init(&sim->process_slab, &sim->arena, sizeof(Process));
+    pool_init(&sim->arrays, &sim->arena);
+
+    mmu_allocate_frames(&sim->mmu, frame_count, page_size);
     mmu_initialize_frames(&sim->mmu);
     algorithms_init(sim);
 }
@@ -810,13 +854,107 @@ void sim_free(Simulator *sim)
     algorithms_free(sim);
 }
 
-void sim_set_future_dataset(Simulator *sim, const FutureUseDataset *dataset)
+void sim_set_policy(Simulator *sim, const ReplacementPolicy *policy)
 {
+    if (!sim || !policy)
+    {
+        return;
+    }
+    algorithms_free(sim);
+    sim->policy = policy;
+    sim->algorithm = ALG_CUSTOM;
+    for (int type = ALG_OPT; type <= ALG_RND; ++type)
+    {
+        if (policy_builtin((AlgorithmType)type) == policy)
+        {
+            sim->algorithm = (AlgorithmType)type;
+        }
+    }
+    algorithms_init(sim);
+    sim_reset(sim);
+}
+
+void sim_set_page_reuse(Simulator *sim, size_t reuse_distance)
+{
+    if (!sim)
+    {
+        return;
+    }
+    sim->page_ids.reuse_distance = reuse_distance;
+}
+
+void sim_set_rng_seed(Simulator *sim, uint64_t seed)
+{
+    if (!sim)
+    {
+        return;
+    }
+    sim->rng_seed = seed;
+    rng_seed(&sim->rng, seed);
+}
+
+void sim_set_future_index(Simulator *sim, const FutureUseIndex *index)
+{
+    if (!sim)
+    {
+        return;
+    }
+    sim->future_index = index;
+}
+
+void sim_rebase_future_index(Simulator *sim, const sim_pageid_t *pages, size_t page_count)
+{
+    if (!sim || !sim->future_index)
+    {
+        return;
+    }
+    for (size_t i = 0; i < page_count; ++i)
+    {
+        if (sim_page_exists(sim, pages[i]))
+        {
+            load_future_use_data(sim, pages[i]);
+        }
+    }
+
+    // Los próximos usos cambiaron de golpe: el heap de OPT se rearma con los marcos ocupados
+    if (sim->algorithm == ALG_OPT && sim->alg_state)
+    {
+        opt_reset(sim, sim->alg_state);
+        for (size_t f = 0; f < sim->mmu.frame_count; ++f)
+        {
+            if (sim->mmu.frames[f].occupied)
+            {
+                opt_on_loaded(sim, sim->alg_state, sim->mmu.frames[f].page_id, (int)f);
+            }
+        }
+    }
+}
+
+// Reporta la memoria que consume el propio simulador, incluidos los máximos de la arena.
+void sim_get_memory_stats(const Simulator *sim, SimMemoryStats *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
     if (!sim)
     {
         return;
     }
-    sim->future_dataset = dataset;
+    out->arena_reserved = sim->arena.bytes_reserved;
+    out->arena_used = sim->arena.bytes_used;
+    out->arena_high_water = sim->arena.high_water;
+    out->ptrmaps_peak = sim->ptrmap_slab.peak;
+    out->processes_peak = sim->process_slab.peak;
+
+    const PageTable *pt = &sim->mmu.pages;
+    size_t per_page = sizeof(*pt->live) + sizeof(*pt->in_ram) + sizeof(*pt->ref_bit) +
+                      sizeof(*pt->frame_index) + sizeof(*pt->last_used) + sizeof(*pt->next_use_pos) +
+                      sizeof(*pt->owner_pid) + sizeof(*pt->owner_ptr) + sizeof(*pt->page_index) +
+                      sizeof(*pt->future_cursor);
+    out->page_table_bytes = pt->capacity * per_page;
+    out->frame_table_bytes = sim->mmu.frame_count * (sizeof(Frame) + sizeof(int));
 }
 
 // Ejecuta una instrucción del flujo global actualizando estadísticas.
@@ -834,10 +972,10 @@ void sim_process_instruction(Simulator *sim, const Instruction *ins, int global_
     switch (ins->type)
     {
     case INS_NEW:
-        handle_new(sim, ins);
+        engine_loops(sim)->handle_new(sim, ins);
         break;
     case INS_USE:
-        handle_use(sim, ins);
+        engine_loops(sim)->handle_use(sim, ins);
         break;
     case INS_DELETE:
         handle_delete(sim, ins);
@@ -861,7 +999,7 @@ size_t mmu_used_frames(const MMU *mmu)
 {
     if (!mmu)
         return 0;
-    return RAM_FRAMES - mmu->free_count;
+    return mmu->frame_count - mmu->free_count;
 }
 
 // Imprime el estado del MMU (solo para depuración por consola).
@@ -870,15 +1008,15 @@ void mmu_debug_dump(const MMU *mmu)
     if (!mmu)
         return;
     printf("---- MMU dump ----\n");
-    printf("Frames used: %zu / %d\n", mmu_used_frames(mmu), RAM_FRAMES);
+    printf("Frames used: %zu / %zu\n", mmu_used_frames(mmu), mmu->frame_count);
     printf("Free list (%zu):", mmu->free_count);
     for (size_t i = 0; i < mmu->free_count; ++i)
         printf(" %d", mmu->free_frames[i]);
     printf("\n");
-    for (int i = 0; i < RAM_FRAMES; ++i)
+    for (size_t i = 0; i < mmu->frame_count; ++i)
     {
         const Frame *f = &mmu->frames[i];
-        printf("Frame %3d: %s page=%u\n", i,
+        printf("Frame %3zu: %s page=%u\n", i,
                f->occupied ? "[X]" : "[ ]",
                f->page_id);
     }
@@ -2,6 +2,7 @@
 #include "sim_engine.h"
 #include "util.h"
 
+#include <pthread.h>
 #include <string.h>
 
 // Función auxiliar para reasignar memoria de forma segura
@@ -20,7 +21,7 @@ static void *mgr_realloc(void *ptr, size_t size) {
 typedef struct PrePtrEntry {
     int valid;              // Indica si la entrada es válida
     uint32_t num_pages;     // Número de páginas que ocupa este puntero
-    sim_pageid_t *pages;    // Array de IDs de páginas asociadas
+    sim_pageid_t first_page; // Primer ID del rango contiguo de páginas asociadas
 } PrePtrEntry;
 
 // Estructura temporal para rastrear procesos durante el preprocesamiento
@@ -32,21 +33,18 @@ typedef struct PreProcessEntry {
     size_t capacity;        // Capacidad del array de punteros
 } PreProcessEntry;
 
-// Libera la memoria del dataset de usos futuros (usado para el algoritmo OPT)
-// Recorre todas las entradas y libera sus arrays de posiciones
-static void free_future_dataset(FutureUseDataset *dataset) {
-    if (!dataset || !dataset->entries) {
+// Libera el índice de usos futuros (usado para el algoritmo OPT)
+static void free_future_index(FutureUseIndex *index) {
+    if (!index) {
         return;
     }
-    for (size_t i = 0; i < dataset->capacity; ++i) {
-        free(dataset->entries[i].positions);
-        dataset->entries[i].positions = NULL;
-        dataset->entries[i].count = 0;
-        dataset->entries[i].capacity = 0;
-    }
-    free(dataset->entries);
-    dataset->entries = NULL;
-    dataset->capacity = 0;
+    free(index->offsets);
+    free(index->positions);
+    free(index->release_at);
+    free(index->next_use);
+    id_map_free(&index->first_use);
+    id_map_free(&index->release_map);
+    memset(index, 0, sizeof(*index));
 }
 
 // Asegura que haya suficiente capacidad en el array de eventos
@@ -59,17 +57,20 @@ static void ensure_event_capacity(SimManager *mgr, size_t needed) {
     while (new_capacity < needed) {
         new_capacity *= 2;
     }
-    mgr->events = mgr_realloc(mgr->events, new_capacity * sizeof(AccessEvent));
+    mgr->events = mgr_realloc(mgr->events, new_capacity * sizeof(sim_pageid_t));
     mgr->event_capacity = new_capacity;
 }
 
-// Agrega un nuevo evento de acceso a página al registro
-// Cada evento vincula una instrucción con una página específica
-static void append_event(SimManager *mgr, size_t instr_index, sim_pageid_t page_id) {
-    ensure_event_capacity(mgr, mgr->event_count + 1);
-    mgr->events[mgr->event_count].instruction_index = instr_index;
-    mgr->events[mgr->event_count].page_id = page_id;
-    mgr->event_count++;
+// Registra que las páginas de un puntero dejan de existir en la instrucción instr_index
+static void append_release(SimManager *mgr, size_t instr_index, const PrePtrEntry *entry) {
+    if (mgr->release_count == mgr->release_capacity) {
+        mgr->release_capacity = mgr->release_capacity ? mgr->release_capacity * 2 : 128;
+        mgr->releases = mgr_realloc(mgr->releases, mgr->release_capacity * sizeof(PageRelease));
+    }
+    PageRelease *release = &mgr->releases[mgr->release_count++];
+    release->instruction_index = instr_index;
+    release->first_page = entry->first_page;
+    release->num_pages = entry->num_pages;
 }
 
 // Asegura que la tabla de punteros tenga capacidad para almacenar el ptr_id dado
@@ -88,7 +89,7 @@ static void ensure_ptr_entry_capacity(PrePtrEntry **table, size_t *capacity, sim
     for (size_t i = *capacity; i < new_capacity; ++i) {
         (*table)[i].valid = 0;
         (*table)[i].num_pages = 0;
-        (*table)[i].pages = NULL;
+        (*table)[i].first_page = 0;
     }
     *capacity = new_capacity;
 }
@@ -146,218 +147,384 @@ static void process_remove_ptr_id(PreProcessEntry *proc, sim_ptr_t ptr_id) {
     }
 }
 
-// Destruye y libera los recursos de una entrada de puntero
-// Marca la entrada como inválida después de liberar la memoria
+// Invalida una entrada de puntero
+// El rango de páginas es implícito, no hay memoria que liberar
 static void destroy_ptr_entry(PrePtrEntry *entry) {
     if (!entry || !entry->valid) {
         return;
     }
-    free(entry->pages);
-    entry->pages = NULL;
+    entry->first_page = 0;
     entry->num_pages = 0;
     entry->valid = 0;
 }
 
-// Agrega una posición de uso futuro a la entrada de una página
-// Utilizado para construir el dataset de predicción del algoritmo OPT
-static void future_entry_append(FutureUseEntry *entry, size_t position) {
-    if (entry->count == entry->capacity) {
-        size_t new_capacity = entry->capacity ? entry->capacity * 2 : 4;
-    entry->positions = mgr_realloc(entry->positions, new_capacity * sizeof(size_t));
-        entry->capacity = new_capacity;
-    }
-    entry->positions[entry->count++] = position;
-}
+// Construye el índice CSR de usos futuros para el algoritmo OPT a partir de los accesos por página
+// contados al emitir los eventos (uses[id + 1], se adopta como offsets): una suma de prefijos y una
+// pasada sobre los eventos que reparte cada posición en su tramo
+static void build_future_index(SimManager *mgr, sim_pageid_t max_page_id, size_t *uses, size_t use_capacity) {
+    free_future_index(&mgr->future_index);
 
-// Reduce el tamaño de memoria de las entradas de usos futuros
-// Libera entradas vacías y ajusta la capacidad al tamaño real usado
-static void shrink_future_entries(FutureUseDataset *dataset) {
-    if (!dataset || !dataset->entries) {
-        return;
-    }
-    for (size_t i = 0; i < dataset->capacity; ++i) {
-        FutureUseEntry *entry = &dataset->entries[i];
-        if (entry->count == 0) {
-            // Libera entradas sin usos futuros
-            free(entry->positions);
-            entry->positions = NULL;
-            entry->capacity = 0;
-        } else if (entry->capacity > entry->count) {
-            // Reduce al tamaño exacto necesario
-            entry->positions = mgr_realloc(entry->positions, entry->count * sizeof(size_t));
-            entry->capacity = entry->count;
-        }
+    // Las posiciones se guardan en 32 bits; FUTURE_USE_NONE queda reservado como centinela
+    if (mgr->event_count >= FUTURE_USE_NONE) {
+        fprintf(stderr, "Too many page events for the OPT future-use index (%zu)\n", mgr->event_count);
+        exit(EXIT_FAILURE);
     }
-}
-
-// Construye el dataset de usos futuros para el algoritmo OPT
-// Recorre todos los eventos y registra cuándo se usará cada página
-static void build_future_dataset(SimManager *mgr, sim_pageid_t max_page_id) {
-    free_future_dataset(&mgr->future_dataset);
 
-    // Crea un array con una entrada por cada página posible
+    FutureUseIndex *index = &mgr->future_index;
     size_t capacity = (size_t)max_page_id + 1;
-    if (capacity == 0) {
-        capacity = 1;
+    index->page_capacity = capacity;
+    index->offsets = mgr_realloc(uses, (capacity + 1) * sizeof(size_t));
+    if (use_capacity < capacity + 1) {
+        memset(index->offsets + use_capacity, 0, (capacity + 1 - use_capacity) * sizeof(size_t));
     }
-    mgr->future_dataset.entries = xmalloc(capacity * sizeof(FutureUseEntry));
-    mgr->future_dataset.capacity = capacity;
+    index->offsets[0] = 0;
+    // Suma de prefijos: offsets[id] pasa a ser el inicio del tramo de la página id
     for (size_t i = 0; i < capacity; ++i) {
-        mgr->future_dataset.entries[i].positions = NULL;
-        mgr->future_dataset.entries[i].count = 0;
-        mgr->future_dataset.entries[i].capacity = 0;
+        index->offsets[i + 1] += index->offsets[i];
     }
+    index->position_count = index->offsets[capacity];
+    index->positions = xmalloc((index->position_count ? index->position_count : 1) * sizeof(uint32_t));
 
-    // Recorre todos los eventos y registra las posiciones de acceso para cada página
+    // Escribe cada posición en el siguiente hueco libre de su página
+    size_t *fill = xmalloc(capacity * sizeof(size_t));
+    memcpy(fill, index->offsets, capacity * sizeof(size_t));
     for (size_t idx = 0; idx < mgr->event_count; ++idx) {
-        sim_pageid_t page_id = mgr->events[idx].page_id;
-        if (page_id >= capacity) {
-            continue;
+        sim_pageid_t page_id = mgr->events[idx];
+        if (page_id < capacity) {
+            index->positions[fill[page_id]++] = (uint32_t)idx;
+        }
+    }
+    free(fill);
+
+    // Instante de liberación de cada página: desempata a OPT entre páginas sin usos futuros
+    index->release_at = xmalloc(capacity * sizeof(uint32_t));
+    memset(index->release_at, 0xff, capacity * sizeof(uint32_t));
+    for (size_t r = 0; r < mgr->release_count; ++r) {
+        const PageRelease *range = &mgr->releases[r];
+        for (uint32_t p = 0; p < range->num_pages; ++p) {
+            sim_pageid_t page_id = range->first_page + p;
+            if (page_id < capacity) {
+                index->release_at[page_id] = (uint32_t)range->instruction_index;
+            }
         }
-        FutureUseEntry *entry = &mgr->future_dataset.entries[page_id];
-        future_entry_append(entry, idx);
     }
-
-    // Optimiza el uso de memoria
-    shrink_future_entries(&mgr->future_dataset);
 }
 
-// Precomputa todos los eventos de acceso a páginas analizando las instrucciones
-// Simula la ejecución para determinar qué páginas se acceden en cada paso
-static void precompute_events(SimManager *mgr) {
+// Tablas temporales del preprocesamiento: punteros y procesos vivos y el asignador de ids de página
+typedef struct PrecomputeState {
+    PrePtrEntry *ptr_table;
+    size_t ptr_capacity;
+    PreProcessEntry *proc_table;
+    size_t proc_capacity;
+    PageIdAllocator page_ids;    // sin reciclar: el índice CSR guarda un solo tramo por id
+    size_t *uses;            // accesos de la página id en uses[id + 1], para el índice de usos futuros
+    size_t use_capacity;
+} PrecomputeState;
+
+// Prepara las tablas temporales y vacía los eventos y liberaciones del administrador
+static void precompute_begin(SimManager *mgr, PrecomputeState *state) {
+    memset(state, 0, sizeof(*state));
+    page_alloc_init(&state->page_ids, PAGE_ALLOC_NO_REUSE);
     mgr->event_count = 0;
+    mgr->release_count = 0;
     mgr->current_event_index = 0;
+}
 
-    // Tablas temporales para rastrear punteros y procesos durante el preprocesamiento
-    PrePtrEntry *ptr_table = NULL;
-    size_t ptr_capacity = 0;
-    PreProcessEntry *proc_table = NULL;
-    size_t proc_capacity = 0;
-
-    sim_pageid_t next_page_id = 1;  // Contador de IDs de página
-
-    // Limpia offsets anteriores si existen
-    if (mgr->instr_event_offsets) {
-        free(mgr->instr_event_offsets);
-        mgr->instr_event_offsets = NULL;
+// Agrega los eventos de acceso a las páginas [first_page, first_page + num_pages) y los cuenta por página
+static void append_span_events(SimManager *mgr, PrecomputeState *state, sim_pageid_t first_page, uint32_t num_pages) {
+    ensure_event_capacity(mgr, mgr->event_count + num_pages);
+    sim_pageid_t *out = mgr->events + mgr->event_count;
+    for (uint32_t p = 0; p < num_pages; ++p) {
+        sim_pageid_t page_id = first_page + p;
+        out[p] = page_id;
+        state->uses[(size_t)page_id + 1]++;
     }
+    mgr->event_count += num_pages;
+}
 
-    // Procesa cada instrucción para generar eventos de acceso a páginas
-    for (size_t i = 0; i < mgr->instr_count; ++i) {
-        Instruction *ins = &mgr->instructions[i];
-        switch (ins->type) {
-            case INS_NEW: {  // Asignación de memoria (new)
-                // Calcula cuántas páginas se necesitan para el tamaño solicitado
-                size_t num_pages = (ins->size + PAGE_SIZE - 1) / PAGE_SIZE;
-                if (num_pages == 0) {
-                    num_pages = 1;
-                }
-                ensure_ptr_entry_capacity(&ptr_table, &ptr_capacity, ins->ptr_id);
-                PrePtrEntry *entry = &ptr_table[ins->ptr_id];
-                destroy_ptr_entry(entry);  // Limpia si ya existía
-                entry->pages = xmalloc(sizeof(sim_pageid_t) * num_pages);
-                entry->num_pages = (uint32_t)num_pages;
-                entry->valid = 1;
-                // Crea y registra un evento de acceso para cada página del puntero
-                for (size_t p = 0; p < num_pages; ++p) {
-                    entry->pages[p] = next_page_id++;
-                    append_event(mgr, i, entry->pages[p]);
+// Genera los eventos de acceso y las liberaciones de la instrucción index
+// Simula la ejecución para determinar qué páginas se acceden en cada paso
+static void precompute_instruction(SimManager *mgr, PrecomputeState *state, const Instruction *ins, size_t index) {
+    switch (ins->type) {
+        case INS_NEW: {  // Asignación de memoria (new)
+            // Calcula cuántas páginas se necesitan para el tamaño solicitado
+            size_t num_pages = (ins->size + mgr->page_size - 1) / mgr->page_size;
+            if (num_pages == 0) {
+                num_pages = 1;
+            }
+            ensure_ptr_entry_capacity(&state->ptr_table, &state->ptr_capacity, ins->ptr_id);
+            PrePtrEntry *entry = &state->ptr_table[ins->ptr_id];
+            destroy_ptr_entry(entry);  // Limpia si ya existía
+            // Mismo asignador que el motor, así los ids coinciden
+            entry->first_page = page_alloc_take(&state->page_ids, (uint32_t)num_pages);
+            entry->num_pages = (uint32_t)num_pages;
+            entry->valid = 1;
+            // Reserva los contadores de las páginas nuevas
+            size_t needed = (size_t)entry->first_page + entry->num_pages + 1;
+            if (needed > state->use_capacity) {
+                size_t new_capacity = state->use_capacity ? state->use_capacity * 2 : 1024;
+                while (new_capacity < needed) {
+                    new_capacity *= 2;
                 }
+                state->uses = mgr_realloc(state->uses, new_capacity * sizeof(size_t));
+                memset(state->uses + state->use_capacity, 0, (new_capacity - state->use_capacity) * sizeof(size_t));
+                state->use_capacity = new_capacity;
+            }
+            // Crea y registra un evento de acceso para cada página del puntero
+            append_span_events(mgr, state, entry->first_page, entry->num_pages);
 
-                // Asocia el puntero con el proceso propietario
-                ensure_process_entry_capacity(&proc_table, &proc_capacity, ins->pid);
-                process_add_ptr_id(&proc_table[ins->pid], ins->ptr_id);
+            // Asocia el puntero con el proceso propietario
+            ensure_process_entry_capacity(&state->proc_table, &state->proc_capacity, ins->pid);
+            process_add_ptr_id(&state->proc_table[ins->pid], ins->ptr_id);
+            break;
+        }
+        case INS_USE: {  // Uso de memoria (use)
+            if (ins->ptr_id >= state->ptr_capacity) {
                 break;
             }
-            case INS_USE: {  // Uso de memoria (use)
-                if (ins->ptr_id >= ptr_capacity) {
-                    break;
-                }
-                PrePtrEntry *entry = &ptr_table[ins->ptr_id];
-                if (!entry->valid) {
-                    break;
-                }
-                // Registra un evento de acceso para cada página del puntero usado
-                for (uint32_t p = 0; p < entry->num_pages; ++p) {
-                    append_event(mgr, i, entry->pages[p]);
-                }
+            PrePtrEntry *entry = &state->ptr_table[ins->ptr_id];
+            if (!entry->valid) {
                 break;
             }
-            case INS_DELETE: {  // Liberación de memoria (delete)
-                if (ins->ptr_id >= ptr_capacity) {
-                    break;
-                }
-                PrePtrEntry *entry = &ptr_table[ins->ptr_id];
-                if (!entry->valid) {
-                    break;
-                }
-                // Destruye la entrada del puntero y lo desvincula del proceso
-                destroy_ptr_entry(entry);
-                if (ins->pid < proc_capacity) {
-                    process_remove_ptr_id(&proc_table[ins->pid], ins->ptr_id);
-                }
+            // Registra un evento de acceso para cada página del puntero usado
+            append_span_events(mgr, state, entry->first_page, entry->num_pages);
+            break;
+        }
+        case INS_DELETE: {  // Liberación de memoria (delete)
+            if (ins->ptr_id >= state->ptr_capacity) {
                 break;
             }
-            case INS_KILL: {  // Terminación de proceso (kill)
-                if (ins->pid >= proc_capacity) {
-                    break;
-                }
-                PreProcessEntry *proc = &proc_table[ins->pid];
-                if (!proc->alive) {
-                    break;
-                }
-                for (size_t p = 0; p < proc->count; ++p) {
-                    sim_ptr_t ptr_id = proc->ptrs[p];
-                    if (ptr_id < ptr_capacity) {
-                        destroy_ptr_entry(&ptr_table[ptr_id]);
-                    }
-                }
-                free(proc->ptrs);
-                proc->ptrs = NULL;
-                proc->count = 0;
-                proc->capacity = 0;
-                proc->alive = 0;
+            PrePtrEntry *entry = &state->ptr_table[ins->ptr_id];
+            if (!entry->valid) {
                 break;
             }
-            default:
+            // Destruye la entrada del puntero y lo desvincula del proceso
+            append_release(mgr, index, entry);
+            page_alloc_release(&state->page_ids, entry->first_page, entry->num_pages);
+            destroy_ptr_entry(entry);
+            if (ins->pid < state->proc_capacity) {
+                process_remove_ptr_id(&state->proc_table[ins->pid], ins->ptr_id);
+            }
+            break;
+        }
+        case INS_KILL: {  // Terminación de proceso (kill)
+            if (ins->pid >= state->proc_capacity) {
+                break;
+            }
+            PreProcessEntry *proc = &state->proc_table[ins->pid];
+            if (!proc->alive) {
                 break;
+            }
+            for (size_t p = 0; p < proc->count; ++p) {
+                sim_ptr_t ptr_id = proc->ptrs[p];
+                if (ptr_id < state->ptr_capacity && state->ptr_table[ptr_id].valid) {
+                    append_release(mgr, index, &state->ptr_table[ptr_id]);
+                    page_alloc_release(&state->page_ids, state->ptr_table[ptr_id].first_page,
+                                       state->ptr_table[ptr_id].num_pages);
+                    destroy_ptr_entry(&state->ptr_table[ptr_id]);
+                }
+            }
+            free(proc->ptrs);
+            proc->ptrs = NULL;
+            proc->count = 0;
+            proc->capacity = 0;
+            proc->alive = 0;
+            break;
         }
+        default:
+            break;
     }
+}
 
+// Libera las tablas temporales, construye el índice de usos futuros y cierra instr_event_offsets
+static void precompute_finish(SimManager *mgr, PrecomputeState *state) {
     // Limpia todas las entradas de la tabla de punteros
-    for (size_t idx = 0; idx < ptr_capacity; ++idx) {
-        destroy_ptr_entry(&ptr_table[idx]);
+    for (size_t idx = 0; idx < state->ptr_capacity; ++idx) {
+        destroy_ptr_entry(&state->ptr_table[idx]);
     }
-    free(ptr_table);
+    free(state->ptr_table);
 
     // Limpia la tabla de procesos
-    if (proc_table) {
-        for (size_t idx = 0; idx < proc_capacity; ++idx) {
-            free(proc_table[idx].ptrs);
+    if (state->proc_table) {
+        for (size_t idx = 0; idx < state->proc_capacity; ++idx) {
+            free(state->proc_table[idx].ptrs);
         }
     }
-    free(proc_table);
+    free(state->proc_table);
 
-    // Construye el dataset de usos futuros para el algoritmo OPT
-    sim_pageid_t max_page_id = next_page_id ? (next_page_id - 1) : 0;
-    build_future_dataset(mgr, max_page_id);
+    // Construye el índice de usos futuros para el algoritmo OPT
+    sim_pageid_t max_page_id = state->page_ids.next - 1;
+    page_alloc_free(&state->page_ids);
+    build_future_index(mgr, max_page_id, state->uses, state->use_capacity);
 
-    // Construye el array de offsets que mapea cada instrucción a sus eventos
-    // Permite búsqueda rápida de los eventos asociados a una instrucción
+    mgr->instr_event_offsets[mgr->instr_count] = mgr->event_count;  // Sentinel
+}
+
+// Precomputa todos los eventos de acceso a páginas analizando las instrucciones
+static void precompute_events(SimManager *mgr) {
+    PrecomputeState state;
+    precompute_begin(mgr, &state);
+
+    // El array de offsets mapea cada instrucción a sus eventos; se llena al empezar cada una
+    free(mgr->instr_event_offsets);
     mgr->instr_event_offsets = xmalloc((mgr->instr_count + 1) * sizeof(size_t));
-    size_t evt_index = 0;
+
+    // Procesa cada instrucción para generar eventos de acceso a páginas
+    for (size_t i = 0; i < mgr->instr_count; ++i) {
+        mgr->instr_event_offsets[i] = mgr->event_count;
+        precompute_instruction(mgr, &state, &mgr->instructions[i], i);
+    }
+
+    precompute_finish(mgr, &state);
+}
+
+// Agrega a la ventana una instrucción leída de la fuente junto con sus eventos
+static void window_append(SimManager *mgr, const TranslatedInstr *step) {
+    const Instruction *ins = &step->ins;
+    // Una entrada más para el centinela de instr_event_offsets
+    if (mgr->instr_count + 1 >= mgr->instr_capacity) {
+        mgr->instr_capacity = mgr->instr_capacity ? mgr->instr_capacity * 2 : 1024;
+        mgr->instructions = mgr_realloc(mgr->instructions, mgr->instr_capacity * sizeof(Instruction));
+        mgr->instr_event_offsets = mgr_realloc(mgr->instr_event_offsets, mgr->instr_capacity * sizeof(size_t));
+    }
+    mgr->instructions[mgr->instr_count] = *ins;
+    mgr->instr_event_offsets[mgr->instr_count] = mgr->event_count;
+    mgr->instr_count++;
+
+    PageSpan span = step->access;
+    ensure_event_capacity(mgr, mgr->event_count + span.num_pages);
+    for (uint32_t p = 0; p < span.num_pages; ++p) {
+        mgr->events[mgr->event_count++] = span.first_page + p;
+    }
+    for (size_t r = 0; r < step->released_count; ++r) {
+        PrePtrEntry entry = {1, step->released[r].num_pages, step->released[r].first_page};
+        append_release(mgr, mgr->instr_count - 1, &entry);
+    }
+}
+
+// Pide la siguiente instrucción traducida: a la fuente traducida o a source pasando por el builder propio.
+static int window_next_step(SimManager *mgr, TranslatedInstr *step) {
+    if (mgr->translated_source) {
+        return mgr->translated_source(mgr->source_ctx, step);
+    }
+    int status = mgr->source(mgr->source_ctx, &step->ins);
+    if (status > 0) {
+        step->access = event_builder_next(&mgr->builder, &step->ins);
+        step->released = mgr->builder.released;
+        step->released_count = mgr->builder.released_count;
+    }
+    return status;
+}
+
+// Agrega a window_pages las páginas que aparecen en la ventana actual
+static void window_collect_pages(SimManager *mgr, size_t *count) {
+    const IdMap *map = &mgr->future_index.first_use;
+    if (*count + map->count > mgr->window_page_capacity) {
+        mgr->window_page_capacity = (*count + map->count) * 2;
+        mgr->window_pages = mgr_realloc(mgr->window_pages, mgr->window_page_capacity * sizeof(sim_pageid_t));
+    }
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->keys[i]) {
+            mgr->window_pages[(*count)++] = map->keys[i];
+        }
+    }
+}
+
+// Rearma el índice de la ventana recorriendo los eventos de atrás hacia adelante: al llegar a un
+// evento, la última aparición vista de su página es su próximo uso
+static void build_window_index(SimManager *mgr) {
+    FutureUseIndex *index = &mgr->future_index;
+    id_map_free(&index->first_use);
+    id_map_init(&index->first_use);
+    index->next_use = mgr_realloc(index->next_use, (mgr->event_count ? mgr->event_count : 1) * sizeof(uint32_t));
+    for (size_t e = mgr->event_count; e-- > 0;) {
+        uint64_t *next = id_map_find(&index->first_use, mgr->events[e]);
+        index->next_use[e] = next ? (uint32_t)*next : FUTURE_USE_NONE;
+        if (next) {
+            *next = e;
+        } else {
+            id_map_put(&index->first_use, mgr->events[e], e);
+        }
+    }
+
+    id_map_free(&index->release_map);
+    id_map_init(&index->release_map);
+    for (size_t r = 0; r < mgr->release_count; ++r) {
+        const PageRelease *range = &mgr->releases[r];
+        for (uint32_t p = 0; p < range->num_pages; ++p) {
+            id_map_put(&index->release_map, range->first_page + p, range->instruction_index);
+        }
+    }
+}
+
+// Descarta lo ya simulado, lee de la fuente hasta tener 2 * window eventos por delante y rearma el
+// índice. Los simuladores reubican los cursores de las páginas de la ventana vieja y de la nueva;
+// cualquier otra página ya tenía FUTURE_USE_NONE y lo conserva
+static void window_advance(SimManager *mgr) {
+    size_t page_count = 0;
+    window_collect_pages(mgr, &page_count);
+
+    size_t drop = mgr->current_index;
+    size_t drop_events = mgr->current_event_index;
+    mgr->instr_count -= drop;
+    memmove(mgr->instructions, mgr->instructions + drop, mgr->instr_count * sizeof(Instruction));
     for (size_t i = 0; i < mgr->instr_count; ++i) {
-        mgr->instr_event_offsets[i] = evt_index;
-        while (evt_index < mgr->event_count && mgr->events[evt_index].instruction_index == i) {
-            ++evt_index;
+        mgr->instr_event_offsets[i] = mgr->instr_event_offsets[i + drop] - drop_events;
+    }
+    mgr->event_count -= drop_events;
+    if (mgr->event_count) {
+        memmove(mgr->events, mgr->events + drop_events, mgr->event_count * sizeof(sim_pageid_t));
+    }
+    size_t kept = 0;
+    for (size_t r = 0; r < mgr->release_count; ++r) {
+        if (mgr->releases[r].instruction_index >= drop) {
+            mgr->releases[kept] = mgr->releases[r];
+            mgr->releases[kept++].instruction_index -= drop;
+        }
+    }
+    mgr->release_count = kept;
+    mgr->instr_base += drop;
+    mgr->event_base += drop_events;
+    mgr->current_index = 0;
+    mgr->current_event_index = 0;
+
+    TranslatedInstr step;
+    while (!mgr->source_done && mgr->event_count < 2 * mgr->window) {
+        int status = window_next_step(mgr, &step);
+        if (status <= 0) {
+            mgr->source_done = 1;
+            mgr->source_error = status < 0;
+            break;
         }
+        window_append(mgr, &step);
+    }
+    mgr->instr_event_offsets[mgr->instr_count] = mgr->event_count;  // Sentinel
+
+    build_window_index(mgr);
+    window_collect_pages(mgr, &page_count);
+
+    // La ventana se rearma cuando se consumieron window eventos, así siempre quedan al menos window
+    size_t stop = 0;
+    while (stop < mgr->instr_count && mgr->instr_event_offsets[stop] < mgr->window) {
+        stop++;
+    }
+    mgr->window_stop = mgr->source_done ? mgr->instr_count : stop;
+
+    for (size_t s = 0; s < mgr->sim_count; ++s) {
+        sim_rebase_future_index(mgr->sims[s], mgr->window_pages, page_count);
     }
-    mgr->instr_event_offsets[mgr->instr_count] = evt_index;  // Sentinel
 }
 
 // Inicializa el administrador de simulación con las instrucciones y el algoritmo del usuario
 // Crea dos simuladores: uno con OPT (óptimo) y otro con el algoritmo elegido por el usuario
 void sim_manager_init(SimManager *mgr, Instruction *instrs, size_t count, AlgorithmType user_alg) {
+    sim_manager_init_with_memory(mgr, instrs, count, user_alg, DEFAULT_RAM_FRAMES, DEFAULT_PAGE_SIZE);
+}
+
+// Inicializa el administrador fijando la cantidad de marcos y el tamaño de página de ambos simuladores
+// El tamaño de página también se usa en el preprocesamiento para calcular las páginas de cada new()
+void sim_manager_init_with_memory(SimManager *mgr, Instruction *instrs, size_t count, AlgorithmType user_alg,
+                                  size_t frame_count, size_t page_size) {
     if (!mgr) {
         return;
     }
@@ -370,26 +537,96 @@ void sim_manager_init(SimManager *mgr, Instruction *instrs, size_t count, Algori
     mgr->current_event_index = 0;
     mgr->running = 0;
     mgr->user_algorithm = user_alg;
+    mgr->frame_count = frame_count ? frame_count : DEFAULT_RAM_FRAMES;
+    mgr->page_size = page_size ? page_size : DEFAULT_PAGE_SIZE;
 
-    // Precomputa todos los eventos de acceso a páginas y construye el dataset de usos futuros
+    // Precomputa todos los eventos de acceso a páginas y construye el índice de usos futuros
     precompute_events(mgr);
 
-    // Crea el simulador con algoritmo OPT (óptimo) para comparación
-    mgr->sim_opt = xmalloc(sizeof(Simulator));
-    sim_init(mgr->sim_opt, "OPT", ALG_OPT);
-    sim_set_future_dataset(mgr->sim_opt, &mgr->future_dataset);
+    // Crea el simulador con algoritmo OPT (óptimo) para comparación y el del usuario
+    mgr->sim_opt = sim_manager_add_simulator(mgr, "OPT", ALG_OPT);
+    mgr->sim_user = sim_manager_add_simulator(mgr, "USER", user_alg);
+}
 
-    // Crea el simulador con el algoritmo seleccionado por el usuario
-    mgr->sim_user = xmalloc(sizeof(Simulator));
-    const char *user_name = "USER";
-    sim_init(mgr->sim_user, user_name, user_alg);
-    sim_set_future_dataset(mgr->sim_user, &mgr->future_dataset);
+// Ventana efectiva: las posiciones de la ventana (hasta 2 * window más una instrucción) se guardan en 32 bits
+static size_t window_clamp(size_t window) {
+    if (window == 0) {
+        return 1;
+    }
+    return window > FUTURE_USE_NONE / 4 ? FUTURE_USE_NONE / 4 : window;
+}
+
+size_t sim_manager_page_reuse_distance(size_t window) {
+    return 2 * window_clamp(window);
+}
+
+// Parte común de los modos ventana: la fuente ya está en mgr; arma la primera ventana y los simuladores.
+static void init_window_mode(SimManager *mgr, AlgorithmType user_alg, size_t frame_count, size_t page_size,
+                             size_t window) {
+    mgr->user_algorithm = user_alg;
+    mgr->frame_count = frame_count ? frame_count : DEFAULT_RAM_FRAMES;
+    mgr->page_size = page_size ? page_size : DEFAULT_PAGE_SIZE;
+    mgr->window = window_clamp(window);
+    event_builder_init(&mgr->builder, mgr->page_size, sim_manager_page_reuse_distance(mgr->window));
+    mgr->instr_capacity = 1024;
+    mgr->instructions = xmalloc(mgr->instr_capacity * sizeof(Instruction));
+    mgr->instr_event_offsets = xmalloc(mgr->instr_capacity * sizeof(size_t));
+    mgr->owns_instructions = 1;
+    window_advance(mgr);
+
+    mgr->sim_opt = sim_manager_add_simulator(mgr, "OPT", ALG_OPT);
+    mgr->sim_user = sim_manager_add_simulator(mgr, "USER", user_alg);
+}
+
+void sim_manager_init_windowed(SimManager *mgr, InstrSourceFn source, void *ctx, AlgorithmType user_alg,
+                               size_t frame_count, size_t page_size, size_t window) {
+    if (!mgr) {
+        return;
+    }
+
+    memset(mgr, 0, sizeof(*mgr));
+    mgr->source = source;
+    mgr->source_ctx = ctx;
+    mgr->source_done = source == NULL;
+    init_window_mode(mgr, user_alg, frame_count, page_size, window);
+}
+
+void sim_manager_init_translated(SimManager *mgr, TranslatedSourceFn source, void *ctx, AlgorithmType user_alg,
+                                 size_t frame_count, size_t page_size, size_t window) {
+    if (!mgr) {
+        return;
+    }
+
+    memset(mgr, 0, sizeof(*mgr));
+    mgr->translated_source = source;
+    mgr->source_ctx = ctx;
+    mgr->source_done = source == NULL;
+    init_window_mode(mgr, user_alg, frame_count, page_size, window);
+}
+
+// Crea un simulador más que comparte las instrucciones, los eventos y el índice de usos futuros
+Simulator *sim_manager_add_simulator(SimManager *mgr, const char *name, AlgorithmType alg) {
+    if (!mgr) {
+        return NULL;
+    }
+    if (mgr->sim_count == mgr->sim_capacity) {
+        mgr->sim_capacity = mgr->sim_capacity ? mgr->sim_capacity * 2 : 4;
+        mgr->sims = mgr_realloc(mgr->sims, mgr->sim_capacity * sizeof(Simulator *));
+    }
+    Simulator *sim = xmalloc(sizeof(Simulator));
+    sim_init(sim, name, alg, mgr->frame_count, mgr->page_size);
+    sim_set_future_index(sim, &mgr->future_index);
+    if (mgr->window) {
+        sim_set_page_reuse(sim, sim_manager_page_reuse_distance(mgr->window));
+    }
+    mgr->sims[mgr->sim_count++] = sim;
+    return sim;
 }
 
 // Avanza la simulación un paso, procesando la siguiente instrucción
-// Ejecuta la instrucción en ambos simuladores (OPT y usuario) para comparación
+// Ejecuta la instrucción en todos los simuladores (OPT, usuario y los agregados) para comparación
 void sim_manager_step(SimManager *mgr) {
-    if (!mgr || !mgr->sim_opt || !mgr->sim_user) {
+    if (!mgr || mgr->sim_count == 0) {
         return;
     }
     if (mgr->current_index >= mgr->instr_count) {
@@ -403,17 +640,127 @@ void sim_manager_step(SimManager *mgr) {
     size_t event_start = mgr->instr_event_offsets ? mgr->instr_event_offsets[mgr->current_index] : mgr->current_event_index;
     size_t event_end = mgr->instr_event_offsets ? mgr->instr_event_offsets[mgr->current_index + 1] : event_start;
 
-    // Procesa la instrucción en ambos simuladores
-    sim_process_instruction(mgr->sim_opt, ins, (int)event_start);
-    sim_process_instruction(mgr->sim_user, ins, (int)event_start);
+    // Procesa la instrucción en todos los simuladores
+    for (size_t s = 0; s < mgr->sim_count; ++s) {
+        sim_process_instruction(mgr->sims[s], ins, (int)event_start);
+    }
 
     // Avanza al siguiente paso
     mgr->current_index++;
     mgr->current_event_index = event_end;
+    if (mgr->window && !mgr->source_done && mgr->current_index >= mgr->window_stop) {
+        window_advance(mgr);
+    }
 
     // Punto de enganche para actualizar la interfaz de usuario (notificar observadores)
 }
 
+// Estado compartido por los hilos de sim_manager_run
+// El hilo llamador publica el tramo [chunk_start, chunk_end) y todos lo procesan entre dos barreras
+typedef struct RunPool {
+    SimManager *mgr;
+    size_t worker_count;
+    size_t chunk_start;
+    size_t chunk_end;
+    int done;
+    pthread_barrier_t start;    // el tramo está publicado
+    pthread_barrier_t finish;   // todos terminaron el tramo
+} RunPool;
+
+typedef struct RunWorker {
+    RunPool *pool;
+    size_t index;
+} RunWorker;
+
+// Procesa el tramo actual en los simuladores asignados al hilo (index, index + worker_count, ...)
+static void run_worker_chunk(RunPool *pool, size_t index) {
+    SimManager *mgr = pool->mgr;
+    for (size_t s = index; s < mgr->sim_count; s += pool->worker_count) {
+        Simulator *sim = mgr->sims[s];
+        for (size_t i = pool->chunk_start; i < pool->chunk_end; ++i) {
+            sim_process_instruction(sim, &mgr->instructions[i], (int)mgr->instr_event_offsets[i]);
+        }
+    }
+}
+
+// Bucle de un hilo auxiliar: espera cada tramo, lo procesa y se sincroniza al final
+static void *run_worker_main(void *arg) {
+    RunWorker *worker = arg;
+    RunPool *pool = worker->pool;
+    for (;;) {
+        pthread_barrier_wait(&pool->start);
+        if (pool->done) {
+            break;
+        }
+        run_worker_chunk(pool, worker->index);
+        pthread_barrier_wait(&pool->finish);
+    }
+    return NULL;
+}
+
+// Corre la carga completa en paralelo: cada simulador es independiente y solo lee los datos compartidos,
+// así que el tiempo total es el del simulador más lento y no la suma
+void sim_manager_run(SimManager *mgr, size_t thread_count) {
+    if (!mgr || mgr->sim_count == 0) {
+        return;
+    }
+    if (thread_count == 0 || thread_count > mgr->sim_count) {
+        thread_count = mgr->sim_count;
+    }
+    if (thread_count == 1) {
+        while (mgr->current_index < mgr->instr_count) {
+            sim_manager_step(mgr);
+        }
+        mgr->running = 0;
+        return;
+    }
+
+    RunPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.mgr = mgr;
+    pool.worker_count = thread_count;
+    pthread_barrier_init(&pool.start, NULL, (unsigned)thread_count);
+    pthread_barrier_init(&pool.finish, NULL, (unsigned)thread_count);
+
+    // El hilo llamador hace de trabajador 0
+    pthread_t *threads = xmalloc((thread_count - 1) * sizeof(pthread_t));
+    RunWorker *workers = xmalloc((thread_count - 1) * sizeof(RunWorker));
+    for (size_t t = 1; t < thread_count; ++t) {
+        workers[t - 1].pool = &pool;
+        workers[t - 1].index = t;
+        if (pthread_create(&threads[t - 1], NULL, run_worker_main, &workers[t - 1]) != 0) {
+            fprintf(stderr, "Cannot start simulation thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    while (mgr->current_index < mgr->instr_count) {
+        size_t end = mgr->current_index + SIM_MANAGER_CHUNK;
+        size_t limit = mgr->window && !mgr->source_done ? mgr->window_stop : mgr->instr_count;
+        pool.chunk_start = mgr->current_index;
+        pool.chunk_end = end < limit ? end : limit;
+        pthread_barrier_wait(&pool.start);
+        run_worker_chunk(&pool, 0);
+        pthread_barrier_wait(&pool.finish);
+        mgr->current_index = pool.chunk_end;
+        mgr->current_event_index = mgr->instr_event_offsets[mgr->current_index];
+        if (mgr->window && !mgr->source_done && mgr->current_index >= mgr->window_stop) {
+            window_advance(mgr);
+        }
+    }
+
+    pool.done = 1;
+    pthread_barrier_wait(&pool.start);
+    for (size_t t = 1; t < thread_count; ++t) {
+        pthread_join(threads[t - 1], NULL);
+    }
+    free(threads);
+    free(workers);
+    pthread_barrier_destroy(&pool.start);
+    pthread_barrier_destroy(&pool.finish);
+    mgr->running = 0;
+}
+
 // Libera todos los recursos del administrador de simulación
 // Debe llamarse al finalizar para evitar fugas de memoria
 void sim_manager_free(SimManager *mgr) {
@@ -431,22 +778,38 @@ void sim_manager_free(SimManager *mgr) {
     free(mgr->instr_event_offsets);
     mgr->instr_event_offsets = NULL;
 
-    // Libera el dataset de usos futuros
-    free_future_dataset(&mgr->future_dataset);
-
-    // Libera el simulador OPT
-    if (mgr->sim_opt) {
-        sim_free(mgr->sim_opt);
-        free(mgr->sim_opt);
-        mgr->sim_opt = NULL;
-    }
-
-    // Libera el simulador del usuario
-    if (mgr->sim_user) {
-        sim_free(mgr->sim_user);
-        free(mgr->sim_user);
-        mgr->sim_user = NULL;
-    }
+    // Libera los rangos de páginas liberadas
+    free(mgr->releases);
+    mgr->releases = NULL;
+    mgr->release_count = 0;
+    mgr->release_capacity = 0;
+
+    // Libera el índice de usos futuros
+    free_future_index(&mgr->future_index);
+
+    // En modo ventana y al cargar desde una fuente las instrucciones son del administrador
+    if (mgr->owns_instructions) {
+        free(mgr->instructions);
+        mgr->owns_instructions = 0;
+    }
+    if (mgr->window) {
+        event_builder_free(&mgr->builder);
+        free(mgr->window_pages);
+        mgr->window_pages = NULL;
+        mgr->window = 0;
+    }
+
+    // Libera todos los simuladores, incluidos OPT y el del usuario
+    for (size_t s = 0; s < mgr->sim_count; ++s) {
+        sim_free(mgr->sims[s]);
+        free(mgr->sims[s]);
+    }
+    free(mgr->sims);
+    mgr->sims = NULL;
+    mgr->sim_count = 0;
+    mgr->sim_capacity = 0;
+    mgr->sim_opt = NULL;
+    mgr->sim_user = NULL;
 
     // Reinicia todos los campos a valores seguros
     mgr->instructions = NULL;
@@ -0,0 +1,248 @@
+#include "trace_file.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Desplazamientos dentro de la cabecera.
+#define HDR_MAGIC 0
+#define HDR_VERSION 8
+#define HDR_RECORD_SIZE 12
+#define HDR_COUNT 16
+#define HDR_TYPE_COUNTS 24
+#define HDR_MAX_PID 56
+#define HDR_MAX_PTR 60
+#define HDR_CHECKSUM 64
+
+// Registros codificados por escritura en trace_file_save.
+#define SAVE_CHUNK 4096
+
+// El mapeo puede usarse como arreglo de Instruction si el host es little-endian y la estructura
+// tiene exactamente la disposición del registro; si no, se decodifica a un arreglo propio.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HOST_LITTLE_ENDIAN 1
+#else
+#define HOST_LITTLE_ENDIAN 0
+#endif
+
+static int native_layout(void) {
+    return HOST_LITTLE_ENDIAN && sizeof(Instruction) == TRACE_RECORD_SIZE && sizeof(InstrType) == 4 &&
+           offsetof(Instruction, type) == 0 && offsetof(Instruction, pid) == 4 &&
+           offsetof(Instruction, size) == 8 && sizeof(size_t) == 8 && offsetof(Instruction, ptr_id) == 16;
+}
+
+// Resumen de un arreglo de instrucciones: lo que guarda la cabecera.
+typedef struct TraceSummary {
+    size_t type_counts[4];
+    sim_pid_t max_pid;
+    sim_ptr_t max_ptr;
+    uint64_t checksum;
+    int bad_type;            // algún tipo fuera de InstrType
+} TraceSummary;
+
+// Recorre los registros una vez acumulando conteos, máximos y una suma de Fletcher sobre las cinco
+// palabras de 32 bits de cada registro (acumuladores de 64 bits; se guarda b rotado xor a).
+static void summarize(const Instruction *list, size_t n, TraceSummary *summary) {
+    memset(summary, 0, sizeof(*summary));
+    uint64_t a = 0;
+    uint64_t b = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Instruction *ins = &list[i];
+        uint32_t type = (uint32_t)ins->type;
+        uint64_t size = (uint64_t)ins->size;
+        a += type;
+        b += a;
+        a += ins->pid;
+        b += a;
+        a += (uint32_t)size;
+        b += a;
+        a += (uint32_t)(size >> 32);
+        b += a;
+        a += ins->ptr_id;
+        b += a;
+        if (type < 4) {
+            summary->type_counts[type]++;
+        } else {
+            summary->bad_type = 1;
+        }
+        if (ins->pid > summary->max_pid) {
+            summary->max_pid = ins->pid;
+        }
+        if (ins->ptr_id > summary->max_ptr) {
+            summary->max_ptr = ins->ptr_id;
+        }
+    }
+    summary->checksum = ((b << 32) | (b >> 32)) ^ a;
+}
+
+int trace_file_is_binary(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    char magic[sizeof(TRACE_MAGIC)];
+    int match = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return match;
+}
+
+// Informa el error, libera lo abierto y devuelve -1.
+static int open_failed(TraceFile *trace, const char *path, const char *reason) {
+    trace_file_close(trace);
+    return trace_error("Binary", path, reason);
+}
+
+int trace_file_open(TraceFile *trace, const char *path) {
+    memset(trace, 0, sizeof(*trace));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return trace_error("Binary", path, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size < TRACE_HEADER_SIZE) {
+        close(fd);
+        return open_failed(trace, path, "not a regular file with a complete header");
+    }
+    // Copia privada: quien escriba en las instrucciones no toca el archivo
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return open_failed(trace, path, strerror(errno));
+    }
+    trace->map = map;
+    trace->map_size = (size_t)st.st_size;
+    madvise(map, trace->map_size, MADV_SEQUENTIAL);
+
+    const uint8_t *header = map;
+    if (memcmp(header + HDR_MAGIC, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        return open_failed(trace, path, "bad magic");
+    }
+    if (get_le32(header + HDR_VERSION) != TRACE_VERSION) {
+        return open_failed(trace, path, "unsupported version");
+    }
+    if (get_le32(header + HDR_RECORD_SIZE) != TRACE_RECORD_SIZE) {
+        return open_failed(trace, path, "unsupported record size");
+    }
+    uint64_t count = get_le64(header + HDR_COUNT);
+    if (count > (trace->map_size - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE ||
+        TRACE_HEADER_SIZE + count * TRACE_RECORD_SIZE != trace->map_size) {
+        return open_failed(trace, path, "file size does not match the record count");
+    }
+    trace->count = (size_t)count;
+    for (int t = 0; t < 4; ++t) {
+        trace->type_counts[t] = (size_t)get_le64(header + HDR_TYPE_COUNTS + 8 * t);
+    }
+    trace->max_pid = get_le32(header + HDR_MAX_PID);
+    trace->max_ptr = get_le32(header + HDR_MAX_PTR);
+
+    uint8_t *records = (uint8_t *)map + TRACE_HEADER_SIZE;
+    if (native_layout()) {
+        trace->instructions = (Instruction *)records;
+    } else {
+        trace->instructions = xmalloc((trace->count ? trace->count : 1) * sizeof(Instruction));
+        trace->owned = 1;
+        for (size_t i = 0; i < trace->count; ++i) {
+            const uint8_t *rec = records + i * TRACE_RECORD_SIZE;
+            Instruction *ins = &trace->instructions[i];
+            ins->type = (InstrType)get_le32(rec);
+            ins->pid = get_le32(rec + 4);
+            ins->size = (size_t)get_le64(rec + 8);
+            ins->ptr_id = get_le32(rec + 16);
+        }
+    }
+
+    // Una sola pasada valida tipos, máximos, conteos y checksum contra la cabecera
+    TraceSummary summary;
+    summarize(trace->instructions, trace->count, &summary);
+    if (summary.bad_type) {
+        return open_failed(trace, path, "invalid instruction type");
+    }
+    if (summary.max_pid != trace->max_pid || summary.max_ptr != trace->max_ptr ||
+        memcmp(summary.type_counts, trace->type_counts, sizeof(summary.type_counts)) != 0) {
+        return open_failed(trace, path, "header counts do not match the records");
+    }
+    if (summary.checksum != get_le64(header + HDR_CHECKSUM)) {
+        return open_failed(trace, path, "checksum mismatch");
+    }
+    // Mismas reglas que el parser de texto: punteros vivos, dueños y procesos coherentes
+    if (instr_validate_all(trace->instructions, trace->count) != 0) {
+        return open_failed(trace, path, "invalid instruction sequence");
+    }
+    return 0;
+}
+
+void trace_file_close(TraceFile *trace) {
+    if (!trace) {
+        return;
+    }
+    if (trace->owned) {
+        free(trace->instructions);
+    }
+    if (trace->map) {
+        munmap(trace->map, trace->map_size);
+    }
+    memset(trace, 0, sizeof(*trace));
+}
+
+int trace_file_save(const char *path, const Instruction *list, size_t n) {
+    if (!path || (!list && n > 0)) {
+        return -1;
+    }
+    TraceSummary summary;
+    summarize(list, n, &summary);
+    if (summary.bad_type) {
+        return trace_error("Binary", path, "invalid instruction type");
+    }
+    if (instr_validate_all(list, n) != 0) {
+        return trace_error("Binary", path, "invalid instruction sequence");
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return trace_error("Binary", path, strerror(errno));
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header + HDR_MAGIC, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    put_le32(header + HDR_VERSION, TRACE_VERSION);
+    put_le32(header + HDR_RECORD_SIZE, TRACE_RECORD_SIZE);
+    put_le64(header + HDR_COUNT, (uint64_t)n);
+    for (int t = 0; t < 4; ++t) {
+        put_le64(header + HDR_TYPE_COUNTS + 8 * t, (uint64_t)summary.type_counts[t]);
+    }
+    put_le32(header + HDR_MAX_PID, summary.max_pid);
+    put_le32(header + HDR_MAX_PTR, summary.max_ptr);
+    put_le64(header + HDR_CHECKSUM, summary.checksum);
+    int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    // Los registros se codifican explícitamente: el relleno de Instruction nunca llega al disco
+    uint8_t *chunk = xmalloc(SAVE_CHUNK * TRACE_RECORD_SIZE);
+    for (size_t start = 0; ok && start < n; start += SAVE_CHUNK) {
+        size_t batch = (n - start < SAVE_CHUNK) ? n - start : SAVE_CHUNK;
+        for (size_t i = 0; i < batch; ++i) {
+            const Instruction *ins = &list[start + i];
+            uint8_t *rec = chunk + i * TRACE_RECORD_SIZE;
+            put_le32(rec, (uint32_t)ins->type);
+            put_le32(rec + 4, ins->pid);
+            put_le64(rec + 8, (uint64_t)ins->size);
+            put_le32(rec + 16, ins->ptr_id);
+            put_le32(rec + 20, 0);
+        }
+        ok = fwrite(chunk, TRACE_RECORD_SIZE, batch, file) == batch;
+    }
+    free(chunk);
+
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        return trace_error("Binary", path, "write failed");
+    }
+    return 0;
+}
@@ -0,0 +1,447 @@
+#include "trace_pack.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Desplazamientos dentro de la cabecera.
+#define HDR_MAGIC 0
+#define HDR_VERSION 8
+#define HDR_BLOCK_SIZE 12
+#define HDR_COUNT 16
+#define HDR_BLOCK_COUNT 24
+#define HDR_INDEX_OFFSET 32
+
+// Byte de etiqueta de cada instrucción: tipo en los bits 0-1 y qué campos no coinciden con la predicción.
+#define TAG_TYPE_MASK 0x03
+#define TAG_PID 0x04         // sigue zigzag(pid - pid anterior)
+#define TAG_PTR 0x08         // sigue zigzag(ptr_id - ptr_id predicho)
+#define TAG_SIZE 0x10        // sigue size (predicción: 0)
+
+// Peor caso codificado por instrucción: etiqueta + pid (5) + ptr_id (5) + size (10).
+#define MAX_ENCODED 21
+
+// Suma de Fletcher sobre palabras little-endian de 64 bits (la última se completa con ceros).
+static uint64_t block_checksum(const uint8_t *data, size_t size) {
+    uint64_t a = 0;
+    uint64_t b = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        a += get_le64(data + i);
+        b += a;
+    }
+    if (i < size) {
+        uint8_t tail[8] = {0};
+        memcpy(tail, data + i, size - i);
+        a += get_le64(tail);
+        b += a;
+    }
+    return ((b << 32) | (b >> 32)) ^ a;
+}
+
+// Los deltas se calculan módulo 2^32 y zigzag los deja chicos en ambas direcciones.
+static uint32_t zigzag32(uint32_t delta) {
+    return (delta << 1) ^ (uint32_t)-(int32_t)(delta >> 31);
+}
+
+static uint32_t unzigzag32(uint32_t value) {
+    return (value >> 1) ^ (uint32_t)-(int32_t)(value & 1);
+}
+
+static uint8_t *put_varint(uint8_t *p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+// Lee un varint de hasta 10 bytes sin pasar de end; devuelve 0 si está truncado o es demasiado largo.
+static inline int get_varint(const uint8_t **cursor, const uint8_t *end, uint64_t *out) {
+    const uint8_t *p = *cursor;
+    uint64_t value = 0;
+    for (unsigned int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *out = value;
+            *cursor = p;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Estado de predicción; se reinicia al empezar cada bloque.
+typedef struct PackPredictor {
+    sim_pid_t pid;           // pid de la instrucción anterior
+    sim_ptr_t ptr;           // último ptr_id de un new/use/delete
+    sim_ptr_t last_new;      // ptr_id del último new (el parser los asigna consecutivos)
+} PackPredictor;
+
+static sim_ptr_t predict_ptr(const PackPredictor *pred, InstrType type) {
+    switch (type) {
+        case INS_NEW:
+            return pred->last_new + 1;
+        case INS_KILL:
+            return 0;
+        default:
+            return pred->ptr;
+    }
+}
+
+static void predictor_update(PackPredictor *pred, const Instruction *ins) {
+    pred->pid = ins->pid;
+    if (ins->type != INS_KILL) {
+        pred->ptr = ins->ptr_id;
+    }
+    if (ins->type == INS_NEW) {
+        pred->last_new = ins->ptr_id;
+    }
+}
+
+// Codifica n instrucciones en out (al menos n * MAX_ENCODED bytes); devuelve los bytes escritos.
+static size_t encode_block(const Instruction *list, size_t n, uint8_t *out) {
+    PackPredictor pred = {0, 0, 0};
+    uint8_t *p = out;
+    for (size_t i = 0; i < n; ++i) {
+        const Instruction *ins = &list[i];
+        sim_ptr_t predicted = predict_ptr(&pred, ins->type);
+        uint8_t *tag = p++;
+        *tag = (uint8_t)(ins->type & TAG_TYPE_MASK);
+        if (ins->pid != pred.pid) {
+            *tag |= TAG_PID;
+            p = put_varint(p, zigzag32(ins->pid - pred.pid));
+        }
+        if (ins->ptr_id != predicted) {
+            *tag |= TAG_PTR;
+            p = put_varint(p, zigzag32(ins->ptr_id - predicted));
+        }
+        if (ins->size != 0) {
+            *tag |= TAG_SIZE;
+            p = put_varint(p, (uint64_t)ins->size);
+        }
+        predictor_update(&pred, ins);
+    }
+    return (size_t)(p - out);
+}
+
+int trace_pack_decode_block(const TracePack *pack, size_t b, Instruction *out) {
+    const TracePackBlock *block = &pack->blocks[b];
+    const uint8_t *p = pack->data + block->offset;
+    const uint8_t *end = p + block->size;
+    if (block_checksum(p, block->size) != block->checksum) {
+        return -1;
+    }
+
+    PackPredictor pred = {0, 0, 0};
+    for (uint32_t i = 0; i < block->count; ++i) {
+        if (p >= end) {
+            return -1;
+        }
+        uint8_t tag = *p++;
+        Instruction *ins = &out[i];
+        ins->type = (InstrType)(tag & TAG_TYPE_MASK);
+        uint64_t value;
+        ins->pid = pred.pid;
+        if (tag & TAG_PID) {
+            if (!get_varint(&p, end, &value)) {
+                return -1;
+            }
+            ins->pid += unzigzag32((uint32_t)value);
+        }
+        ins->ptr_id = predict_ptr(&pred, ins->type);
+        if (tag & TAG_PTR) {
+            if (!get_varint(&p, end, &value)) {
+                return -1;
+            }
+            ins->ptr_id += unzigzag32((uint32_t)value);
+        }
+        ins->size = 0;
+        if (tag & TAG_SIZE) {
+            if (!get_varint(&p, end, &value)) {
+                return -1;
+            }
+            ins->size = (size_t)value;
+        }
+        predictor_update(&pred, ins);
+    }
+    return p == end ? 0 : -1;
+}
+
+int trace_pack_is_packed(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    char magic[sizeof(TRACE_PACK_MAGIC)];
+    int match = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                memcmp(magic, TRACE_PACK_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return match;
+}
+
+// Informa el error, libera lo abierto y devuelve -1.
+static int open_failed(TracePack *pack, const char *path, const char *reason) {
+    trace_pack_close(pack);
+    return trace_error("Packed", path, reason);
+}
+
+int trace_pack_open(TracePack *pack, const char *path) {
+    memset(pack, 0, sizeof(*pack));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return trace_error("Packed", path, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size < TRACE_PACK_HEADER_SIZE) {
+        close(fd);
+        return open_failed(pack, path, "not a regular file with a complete header");
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return open_failed(pack, path, strerror(errno));
+    }
+    pack->data = map;
+    pack->size = (size_t)st.st_size;
+
+    const uint8_t *header = pack->data;
+    if (memcmp(header + HDR_MAGIC, TRACE_PACK_MAGIC, sizeof(TRACE_PACK_MAGIC)) != 0) {
+        return open_failed(pack, path, "bad magic");
+    }
+    if (get_le32(header + HDR_VERSION) != TRACE_PACK_VERSION) {
+        return open_failed(pack, path, "unsupported version");
+    }
+    uint64_t block_size = get_le32(header + HDR_BLOCK_SIZE);
+    uint64_t count = get_le64(header + HDR_COUNT);
+    uint64_t block_count = get_le64(header + HDR_BLOCK_COUNT);
+    uint64_t index_offset = get_le64(header + HDR_INDEX_OFFSET);
+    if (block_size == 0 || block_size > UINT32_MAX / MAX_ENCODED || block_count != (count + block_size - 1) / block_size) {
+        return open_failed(pack, path, "block count does not match the instruction count");
+    }
+    // El índice ocupa exactamente el final del archivo
+    if (index_offset < TRACE_PACK_HEADER_SIZE || index_offset > pack->size ||
+        block_count > (pack->size - index_offset) / TRACE_PACK_INDEX_ENTRY_SIZE ||
+        index_offset + block_count * TRACE_PACK_INDEX_ENTRY_SIZE != pack->size) {
+        return open_failed(pack, path, "bad block index");
+    }
+    pack->count = (size_t)count;
+    pack->block_size = (size_t)block_size;
+    pack->block_count = (size_t)block_count;
+    pack->blocks = xmalloc((pack->block_count ? pack->block_count : 1) * sizeof(TracePackBlock));
+
+    for (size_t b = 0; b < pack->block_count; ++b) {
+        const uint8_t *entry = pack->data + index_offset + b * TRACE_PACK_INDEX_ENTRY_SIZE;
+        TracePackBlock *block = &pack->blocks[b];
+        block->offset = get_le64(entry);
+        block->size = get_le32(entry + 8);
+        block->count = get_le32(entry + 12);
+        block->checksum = get_le64(entry + 16);
+        size_t expected = (b + 1 < pack->block_count) ? pack->block_size : pack->count - b * pack->block_size;
+        if (block->count != expected || block->offset < TRACE_PACK_HEADER_SIZE || block->offset > index_offset ||
+            block->size > index_offset - block->offset) {
+            return open_failed(pack, path, "bad block index");
+        }
+    }
+    madvise(map, pack->size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void trace_pack_close(TracePack *pack) {
+    if (!pack) {
+        return;
+    }
+    if (pack->data) {
+        munmap((void *)pack->data, pack->size);
+    }
+    free(pack->blocks);
+    memset(pack, 0, sizeof(*pack));
+}
+
+// Trabajo de un hilo de decodificación: bloques index, index + worker_count, ...
+typedef struct DecodeWorker {
+    const TracePack *pack;
+    Instruction *out;
+    size_t index;
+    size_t worker_count;
+    int failed;
+} DecodeWorker;
+
+static void *decode_worker_main(void *arg) {
+    DecodeWorker *worker = arg;
+    const TracePack *pack = worker->pack;
+    for (size_t b = worker->index; b < pack->block_count && !worker->failed; b += worker->worker_count) {
+        if (trace_pack_decode_block(pack, b, worker->out + b * pack->block_size) != 0) {
+            worker->failed = 1;
+        }
+    }
+    return NULL;
+}
+
+Instruction *trace_pack_decode_all(const TracePack *pack, size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (threads > pack->block_count) {
+        threads = pack->block_count ? pack->block_count : 1;
+    }
+
+    Instruction *out = xmalloc((pack->count ? pack->count : 1) * sizeof(Instruction));
+    DecodeWorker *workers = xmalloc(threads * sizeof(DecodeWorker));
+    pthread_t *handles = xmalloc(threads * sizeof(pthread_t));
+    for (size_t t = 0; t < threads; ++t) {
+        workers[t] = (DecodeWorker){pack, out, t, threads, 0};
+    }
+    // El hilo llamador decodifica la parte 0
+    for (size_t t = 1; t < threads; ++t) {
+        if (pthread_create(&handles[t], NULL, decode_worker_main, &workers[t]) != 0) {
+            fprintf(stderr, "Cannot start decode thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    decode_worker_main(&workers[0]);
+    int failed = workers[0].failed;
+    for (size_t t = 1; t < threads; ++t) {
+        pthread_join(handles[t], NULL);
+        failed |= workers[t].failed;
+    }
+    free(handles);
+    free(workers);
+
+    if (failed) {
+        fprintf(stderr, "Packed trace error: corrupt block\n");
+        free(out);
+        return NULL;
+    }
+    // La semántica depende del orden de la traza: se valida en una pasada secuencial
+    if (instr_validate_all(out, pack->count) != 0) {
+        fprintf(stderr, "Packed trace error: invalid instruction sequence\n");
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+void trace_pack_reader_init(TracePackReader *reader, const TracePack *pack) {
+    memset(reader, 0, sizeof(*reader));
+    reader->pack = pack;
+    // El búfer sigue al bloque más grande del índice, no al block_size declarado en la cabecera
+    size_t capacity = 1;
+    for (size_t b = 0; b < pack->block_count; ++b) {
+        if (pack->blocks[b].count > capacity) {
+            capacity = pack->blocks[b].count;
+        }
+    }
+    reader->buffer = xmalloc(capacity * sizeof(Instruction));
+    reader->validator = instr_validator_create();
+}
+
+int trace_pack_reader_next(TracePackReader *reader, Instruction *out) {
+    if (reader->next == reader->buffered) {
+        const TracePack *pack = reader->pack;
+        if (reader->block >= pack->block_count) {
+            return 0;
+        }
+        if (trace_pack_decode_block(pack, reader->block, reader->buffer) != 0) {
+            fprintf(stderr, "Packed trace error: corrupt block %zu\n", reader->block);
+            return -1;
+        }
+        reader->buffered = pack->blocks[reader->block].count;
+        reader->next = 0;
+        reader->block++;
+    }
+    *out = reader->buffer[reader->next++];
+    if (instr_validator_check(reader->validator, out) != 0) {
+        fprintf(stderr, "Packed trace error: invalid instruction sequence\n");
+        return -1;
+    }
+    return 1;
+}
+
+void trace_pack_reader_free(TracePackReader *reader) {
+    if (!reader) {
+        return;
+    }
+    free(reader->buffer);
+    reader->buffer = NULL;
+    instr_validator_free(reader->validator);
+    reader->validator = NULL;
+}
+
+int trace_pack_save(const char *path, const Instruction *list, size_t n, size_t block_size) {
+    if (!path || (!list && n > 0)) {
+        return -1;
+    }
+    if (block_size == 0) {
+        block_size = TRACE_PACK_DEFAULT_BLOCK;
+    }
+    if (block_size > UINT32_MAX / MAX_ENCODED) {
+        return trace_error("Packed", path, "block size too large");
+    }
+    // El tipo ocupa dos bits de la etiqueta
+    for (size_t i = 0; i < n; ++i) {
+        if ((unsigned int)list[i].type > INS_KILL) {
+            return trace_error("Packed", path, "invalid instruction type");
+        }
+    }
+    if (instr_validate_all(list, n) != 0) {
+        return trace_error("Packed", path, "invalid instruction sequence");
+    }
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return trace_error("Packed", path, strerror(errno));
+    }
+
+    // La cabecera se reescribe al final, cuando se conoce la posición del índice
+    uint8_t header[TRACE_PACK_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    size_t block_count = (n + block_size - 1) / block_size;
+    uint8_t *index = xmalloc((block_count ? block_count : 1) * TRACE_PACK_INDEX_ENTRY_SIZE);
+    uint8_t *encoded = xmalloc(block_size * MAX_ENCODED);
+    uint64_t offset = TRACE_PACK_HEADER_SIZE;
+    for (size_t b = 0; ok && b < block_count; ++b) {
+        size_t start = b * block_size;
+        size_t count = (n - start < block_size) ? n - start : block_size;
+        size_t size = encode_block(list + start, count, encoded);
+        uint8_t *entry = index + b * TRACE_PACK_INDEX_ENTRY_SIZE;
+        put_le64(entry, offset);
+        put_le32(entry + 8, (uint32_t)size);
+        put_le32(entry + 12, (uint32_t)count);
+        put_le64(entry + 16, block_checksum(encoded, size));
+        ok = fwrite(encoded, 1, size, file) == size;
+        offset += size;
+    }
+    free(encoded);
+
+    if (ok) {
+        ok = fwrite(index, TRACE_PACK_INDEX_ENTRY_SIZE, block_count, file) == block_count;
+    }
+    free(index);
+
+    memcpy(header + HDR_MAGIC, TRACE_PACK_MAGIC, sizeof(TRACE_PACK_MAGIC));
+    put_le32(header + HDR_VERSION, TRACE_PACK_VERSION);
+    put_le32(header + HDR_BLOCK_SIZE, (uint32_t)block_size);
+    put_le64(header + HDR_COUNT, (uint64_t)n);
+    put_le64(header + HDR_BLOCK_COUNT, (uint64_t)block_count);
+    put_le64(header + HDR_INDEX_OFFSET, offset);
+    if (ok) {
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    }
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        return trace_error("Packed", path, "write failed");
+    }
+    return 0;
+}
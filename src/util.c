@@ -24,3 +24,54 @@ void log_debug(const char *fmt, ...) {
 int random_int(int min, int max) {
     return min + rand() % (max - min + 1);
 }
+
+#define RNG_MULTIPLIER 6364136223846793005ULL
+#define RNG_STREAM 0xda3e39cb94b95bdbULL
+
+// Siembra el PCG32 con el procedimiento de referencia: avanza, suma la semilla y vuelve a avanzar.
+void rng_seed(SimRng *rng, uint64_t seed) {
+    rng->state = 0;
+    rng->inc = (RNG_STREAM << 1) | 1u;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+// PCG32 XSH-RR: congruencial de 64 bits con permutación de salida de 32 bits.
+uint32_t rng_next(SimRng *rng) {
+    uint64_t old = rng->state;
+    rng->state = old * RNG_MULTIPLIER + rng->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+// Reduce al rango con multiplicación y rechazo (método de Lemire) para evitar el sesgo de %.
+uint32_t rng_bounded(SimRng *rng, uint32_t bound) {
+    uint64_t m = (uint64_t)rng_next(rng) * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            m = (uint64_t)rng_next(rng) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// Finalizador de SplitMix64: biyectivo y con buena avalancha aun para ids consecutivos.
+uint64_t mix_u64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Mensaje común de los lectores y escritores de trazas binarias y comprimidas.
+int trace_error(const char *kind, const char *path, const char *reason) {
+    fprintf(stderr, "%s trace error in %s: %s\n", kind, path, reason);
+    return -1;
+}
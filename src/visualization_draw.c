@@ -1,4 +1,5 @@
 #include "visualization_draw.h"
+#include "algorithms.h"
 
 #include <stdarg.h>
 #include <cairo.h>
@@ -41,30 +42,25 @@ gboolean draw_ram_bar_cb(GtkWidget *widget, cairo_t *cr, gpointer user_data)
     if (w <= 0 || h <= 0)
         return FALSE;
 
-    double cw = w / (double)RAM_FRAMES;
+    size_t frame_count = sim->mmu.frame_count;
+    if (frame_count == 0)
+        return FALSE;
+
+    double cw = w / (double)frame_count;
     cairo_set_font_size(cr, fmax(8.0, h * 0.4));
 
-    for (int i = 0; i < RAM_FRAMES; ++i)
+    for (size_t i = 0; i < frame_count; ++i)
     {
         double x = i * cw;
         Frame *f = &sim->mmu.frames[i];
 
         if (f->occupied)
         {
-            // Color según PID del propietario
-            Page *page = NULL;
-            for (size_t j = 0; j < sim->mmu.page_count; ++j)
-            {
-                if (sim->mmu.pages[j] && sim->mmu.pages[j]->id == f->page_id)
-                {
-                    page = sim->mmu.pages[j];
-                    break;
-                }
-            }
-
+            // Color según PID del propietario (la tabla de páginas se indexa por id)
+            const PageTable *pt = &sim->mmu.pages;
             double rC = 0.4, gC = 0.4, bC = 0.4;
-            if (page)
-                pid_to_color(page->owner_pid, &rC, &gC, &bC);
+            if (f->page_id < pt->capacity && pt->live[f->page_id])
+                pid_to_color(pt->owner_pid[f->page_id], &rC, &gC, &bC);
             cairo_set_source_rgb(cr, rC, gC, bC);
         }
         else
@@ -107,20 +103,21 @@ void update_visual_stats(GtkWidget *container, const Simulator *sim)
 
     /* Contar frames ocupados (páginas realmente en RAM) */
     size_t pages_in_ram = 0;
-    for (int i = 0; i < RAM_FRAMES; ++i)
+    for (size_t i = 0; i < sim->mmu.frame_count; ++i)
     {
         const Frame *f = &sim->mmu.frames[i];
         if (f->occupied)
             ++pages_in_ram;
     }
 
-    /* RAM usada = frames ocupadas * PAGE_SIZE */
-    double ram_kb = pages_in_ram * (PAGE_SIZE / 1024.0);
-    double ram_total_kb = (RAM_FRAMES * PAGE_SIZE) / 1024.0;
+    /* RAM usada = frames ocupadas * page_size */
+    double page_kb = sim->mmu.page_size / 1024.0;
+    double ram_kb = pages_in_ram * page_kb;
+    double ram_total_kb = sim->mmu.frame_count * page_kb;
     double ram_percent = (ram_total_kb > 0.0) ? (ram_kb / ram_total_kb) * 100.0 : 0.0;
 
     /* vRAM: páginas en swap */
-    double vram_kb = sim->total_pages_in_swap * (PAGE_SIZE / 1024.0);
+    double vram_kb = sim->total_pages_in_swap * page_kb;
     double vram_percent = (ram_total_kb > 0.0) ? (vram_kb / ram_total_kb) * 100.0 : 0.0;
 
     double thrash_percent = (sim->clock > 0)
@@ -187,49 +184,51 @@ GtkWidget *create_page_table(const Simulator *sim)
         gtk_grid_attach(GTK_GRID(grid), lbl, c, 0, 1, 1);
     }
 
-    for (size_t i = 0; i < sim->mmu.page_count; ++i)
+    const PageTable *pt = &sim->mmu.pages;
+    gint row = 1;
+    for (size_t id = 1; id < pt->capacity; ++id)
     {
-        Page *p = sim->mmu.pages[i];
-        if (!p)
+        if (!pt->live[id])
             continue;
 
         char buf[64];
         double rC, gC, bC;
-        pid_to_color(p->owner_pid, &rC, &gC, &bC);
+        pid_to_color(pt->owner_pid[id], &rC, &gC, &bC);
 
         // PAGE ID con color
-        snprintf(buf, sizeof(buf), "%u", p->id);
+        snprintf(buf, sizeof(buf), "%zu", id);
         GtkWidget *lbl_pid = gtk_label_new(buf);
         apply_label_color(lbl_pid, rC, gC, bC);
-        gtk_grid_attach(GTK_GRID(grid), lbl_pid, 0, (gint)(i + 1), 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), lbl_pid, 0, row, 1, 1);
 
         // PID
-        snprintf(buf, sizeof(buf), "%u", p->owner_pid);
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 1, (gint)(i + 1), 1, 1);
+        snprintf(buf, sizeof(buf), "%u", pt->owner_pid[id]);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 1, row, 1, 1);
 
         // LOADED
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(p->in_ram ? "X" : ""),
-                        2, (gint)(i + 1), 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(pt->in_ram[id] ? "X" : ""),
+                        2, row, 1, 1);
 
         // L-ADDR
-        snprintf(buf, sizeof(buf), "%u", p->page_index);
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 3, (gint)(i + 1), 1, 1);
+        snprintf(buf, sizeof(buf), "%u", pt->page_index[id]);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 3, row, 1, 1);
 
         // M-ADDR (frame)
-        snprintf(buf, sizeof(buf), "%d", p->frame_index);
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 4, (gint)(i + 1), 1, 1);
+        snprintf(buf, sizeof(buf), "%d", (int)pt->frame_index[id]);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 4, row, 1, 1);
 
         // D-ADDR
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(p->in_ram ? "-" : "SWAP"),
-                        5, (gint)(i + 1), 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(pt->in_ram[id] ? "-" : "SWAP"),
+                        5, row, 1, 1);
 
         // LOADED-T
-        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)p->last_used);
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 6, (gint)(i + 1), 1, 1);
+        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)pt->last_used[id]);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(buf), 6, row, 1, 1);
 
         // MARK
         gtk_grid_attach(GTK_GRID(grid),
-                        gtk_label_new(p->ref_bit ? "1" : "0"), 7, (gint)(i + 1), 1, 1);
+                        gtk_label_new(algorithms_page_referenced(sim, id) ? "1" : "0"), 7, row, 1, 1);
+        ++row;
     }
 
     gtk_widget_show_all(scrolled);